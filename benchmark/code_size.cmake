@@ -0,0 +1,16 @@
+# Reports the sizes of the object files of the small_vector_ref_code_size target.
+# Usage: cmake -D TEMPLATE_OBJECT=<path> -D REF_OBJECT=<path> [-D SIZE_TOOL=<path>] -P code_size.cmake
+
+file(SIZE "${TEMPLATE_OBJECT}" template_size)
+file(SIZE "${REF_OBJECT}" ref_size)
+
+math(EXPR reduction "100 - 100 * ${ref_size} / ${template_size}")
+
+message(STATUS "Object file size with templated functions:     ${template_size} bytes")
+message(STATUS "Object file size with small_vector_ref:         ${ref_size} bytes")
+message(STATUS "Reduction:                                      ${reduction}%")
+
+# The object files also contain the symbol tables and relocations, the size tool reports the size of the code only
+if(SIZE_TOOL)
+    execute_process(COMMAND "${SIZE_TOOL}" "${TEMPLATE_OBJECT}" "${REF_OBJECT}")
+endif()
@@ -0,0 +1,46 @@
+# Measures the build times of the small_vector_compile_time_* targets in an already configured build directory.
+# Usage: cmake -D BUILD_DIR=<path> [-D VARIANTS=header;extern;module] [-D JOBS=<count>] -P compile_time.cmake
+#
+# Every target is built once first, so that its dependencies (the small_vector_instantiations library and the module
+# interface) are up to date and excluded from the measurement. Then the sources of the target are touched, and the
+# time it takes to rebuild them is reported.
+
+cmake_minimum_required(VERSION 3.23)
+
+if(NOT BUILD_DIR)
+    message(FATAL_ERROR "The BUILD_DIR of the benchmarks must be specified.")
+endif()
+
+if(NOT VARIANTS)
+    set(VARIANTS header extern module)
+endif()
+
+# The translation units are compiled one at a time by default, so the times aren't affected by the number of cores
+if(NOT JOBS)
+    set(JOBS 1)
+endif()
+
+foreach(variant IN LISTS VARIANTS)
+    set(target "small_vector_compile_time_${variant}")
+
+    file(GLOB_RECURSE sources "${BUILD_DIR}/*.cpp")
+    list(FILTER sources INCLUDE REGEX "/${target}/[^/]*\\.cpp$")
+    if(NOT sources)
+        message(STATUS "${target}: not configured, skipped")
+        continue()
+    endif()
+    list(LENGTH sources source_count)
+
+    execute_process(COMMAND "${CMAKE_COMMAND}" --build "${BUILD_DIR}" --target "${target}" --parallel "${JOBS}" OUTPUT_QUIET COMMAND_ERROR_IS_FATAL ANY)
+
+    file(TOUCH_NOCREATE ${sources})
+
+    string(TIMESTAMP start "%s%f")
+    execute_process(COMMAND "${CMAKE_COMMAND}" --build "${BUILD_DIR}" --target "${target}" --parallel "${JOBS}" OUTPUT_QUIET COMMAND_ERROR_IS_FATAL ANY)
+    string(TIMESTAMP stop "%s%f")
+
+    math(EXPR elapsed_ms "(${stop} - ${start}) / 1000")
+    math(EXPR per_tu_ms "${elapsed_ms} / ${source_count}")
+
+    message(STATUS "${target}: ${source_count} translation units in ${elapsed_ms} ms (${per_tu_ms} ms per translation unit)")
+endforeach()
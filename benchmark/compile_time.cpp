@@ -0,0 +1,92 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// A translation unit with typical uses of small_vector<int>, small_vector<double> and small_vector<std::string>.
+// The small_vector_compile_time_* targets compile SV_COMPILE_TIME_TU_COUNT copies of it: including the header,
+// including the header with the extern template declarations of the small_vector_instantiations library, and
+// importing the small_vector module with SV_COMPILE_TIME_MODULE=1. The build times of the targets are measured
+// by the compile_time.cmake script.
+
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <numeric>
+#include <cstddef>
+
+#if SV_COMPILE_TIME_MODULE
+import small_vector;
+#else
+#include <small_vector.hpp>
+#endif
+
+small_vector<std::string> split_words(std::string_view text)
+{
+    small_vector<std::string> words;
+    size_t first = 0;
+    while (first < text.size())
+    {
+        const size_t last = std::min(text.find(' ', first), text.size());
+        if (last != first) words.emplace_back(text.substr(first, last - first));
+        first = last + 1;
+    }
+    return words;
+}
+
+std::string join_sorted_words(std::string_view text)
+{
+    small_vector<std::string> words = split_words(text);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    std::string result;
+    for (const std::string& word : words) result += word + ' ';
+    return result;
+}
+
+small_vector<int> merge_sorted(const small_vector<int>& lhs, const small_vector<int>& rhs)
+{
+    small_vector<int> result;
+    result.reserve(lhs.size() + rhs.size());
+    std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+    return result;
+}
+
+small_vector<int> histogram(const small_vector<int>& values, int bucket_count)
+{
+    small_vector<int> buckets(size_t(bucket_count), 0);
+    for (int value : values)
+    {
+        if (0 <= value && value < bucket_count) buckets[size_t(value)]++;
+    }
+    erase_if(buckets, [](int count) { return count == 0; });
+    return buckets;
+}
+
+double mean(const small_vector<double>& values)
+{
+    return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / double(values.size());
+}
+
+small_vector<double> moving_average(const small_vector<double>& values, size_t window)
+{
+    small_vector<double> result;
+    small_vector<double> current;
+    for (double value : values)
+    {
+        if (current.size() == window) current.erase(current.begin());
+        current.push_back(value);
+        result.push_back(mean(current));
+    }
+    result.shrink_to_fit();
+    return result;
+}
+
+bool same_words(std::string_view lhs, std::string_view rhs)
+{
+    small_vector<std::string> lhs_words = split_words(lhs);
+    small_vector<std::string> rhs_words = split_words(rhs);
+    lhs_words.insert(lhs_words.begin(), "");
+    rhs_words.insert(rhs_words.begin(), "");
+    lhs_words.resize(rhs_words.size());
+
+    return lhs_words == rhs_words;
+}
@@ -0,0 +1,356 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// Workload-level benchmarks modelled on the typical uses of small_vector, comparing small_vector with different
+// inline capacities against std::vector. Unlike the benchmarks of the single operations, these also show the
+// effects of the memory layout on the caches and of the number of allocations on the allocator. Each benchmark
+// reports its throughput (items_per_second), the growth of the peak resident set size (peak_rss), and the
+// allocation and hardware counters per iteration.
+
+#include <benchmark/benchmark.h>
+#include <small_vector.hpp>
+#include "perf_counters.hpp"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <array>
+#include <algorithm>
+#include <random>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+template<size_t Size>
+struct small_vector_of
+{
+    template<typename T>
+    using type = small_vector<T, Size>;
+};
+
+struct std_vector_of
+{
+    template<typename T>
+    using type = std::vector<T>;
+};
+
+inline constexpr uint64_t SEED = 0x5eed;
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// The edges of a directed graph with a power-law out-degree distribution (most vertices have only a few edges,
+// but there are a few with a very large number of them), in a random order.
+struct graph_edges
+{
+    uint32_t vertex_count;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+};
+
+static const graph_edges& power_law_graph()
+{
+    static const graph_edges graph = []
+    {
+        constexpr uint32_t VERTEX_COUNT = 1 << 16;
+        constexpr double EXPONENT = 2.1;
+
+        std::mt19937_64 rng(SEED);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::uniform_int_distribution<uint32_t> vertex(0, VERTEX_COUNT - 1);
+
+        graph_edges graph{ VERTEX_COUNT, {} };
+        for (uint32_t source = 0; source < VERTEX_COUNT; source++)
+        {
+            const double degree = std::pow(1.0 - unit(rng), -1.0 / (EXPONENT - 1.0));
+            const uint32_t out_degree = uint32_t(std::min(degree, double(VERTEX_COUNT / 16)));
+
+            for (uint32_t i = 0; i < out_degree; i++) graph.edges.emplace_back(source, vertex(rng));
+        }
+        std::shuffle(graph.edges.begin(), graph.edges.end(), rng);
+
+        return graph;
+    }();
+
+    return graph;
+}
+
+template<typename VectorOf>
+void macro_graph_adjacency(benchmark::State& state)
+{
+    using adjacency_list = typename VectorOf::template type<uint32_t>;
+
+    const graph_edges& graph = power_law_graph();
+
+    scoped_peak_rss peak_rss(state);
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        std::vector<adjacency_list> adjacency(graph.vertex_count);
+        for (const auto& [source, target] : graph.edges) adjacency[source].push_back(target);
+
+        // The sum of the out-degrees of the neighbours of each vertex
+        uint64_t sum = 0;
+        for (const adjacency_list& neighbours : adjacency)
+        {
+            for (uint32_t target : neighbours) sum += adjacency[target].size();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * graph.edges.size());
+}
+
+BENCHMARK(macro_graph_adjacency<std_vector_of>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_graph_adjacency<small_vector_of<2>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_graph_adjacency<small_vector_of<4>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_graph_adjacency<small_vector_of<8>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_graph_adjacency<small_vector_of<16>>)->Unit(benchmark::kMillisecond);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// A text of random words separated by spaces and newlines.
+static const std::string& text_corpus()
+{
+    static const std::string corpus = []
+    {
+        constexpr size_t LINE_COUNT = 200'000;
+
+        std::mt19937_64 rng(SEED);
+        std::geometric_distribution<size_t> words_per_line(0.15);
+        std::geometric_distribution<size_t> word_length(0.3);
+        std::uniform_int_distribution<int> letter('a', 'z');
+
+        std::string corpus;
+        for (size_t line = 0; line < LINE_COUNT; line++)
+        {
+            const size_t word_count = 1 + words_per_line(rng);
+            for (size_t word = 0; word < word_count; word++)
+            {
+                if (word != 0) corpus.push_back(' ');
+                const size_t length = 1 + word_length(rng);
+                for (size_t i = 0; i < length; i++) corpus.push_back(char(letter(rng)));
+            }
+            corpus.push_back('\n');
+        }
+        return corpus;
+    }();
+
+    return corpus;
+}
+
+template<typename VectorOf>
+void macro_tokenize(benchmark::State& state)
+{
+    using token_list = typename VectorOf::template type<std::string_view>;
+
+    const std::string_view corpus = text_corpus();
+    size_t token_count = 0;
+
+    scoped_peak_rss peak_rss(state);
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        std::vector<token_list> lines;
+
+        size_t line_begin = 0;
+        while (line_begin < corpus.size())
+        {
+            const size_t line_end = corpus.find('\n', line_begin);
+            const std::string_view line = corpus.substr(line_begin, line_end - line_begin);
+
+            token_list& tokens = lines.emplace_back();
+            size_t token_begin = 0;
+            while (token_begin <= line.size())
+            {
+                const size_t token_end = std::min(line.find(' ', token_begin), line.size());
+                tokens.push_back(line.substr(token_begin, token_end - token_begin));
+                token_begin = token_end + 1;
+            }
+            line_begin = line_end + 1;
+        }
+
+        token_count = 0;
+        for (const token_list& tokens : lines) token_count += tokens.size();
+        benchmark::DoNotOptimize(token_count);
+    }
+    state.SetItemsProcessed(state.iterations() * token_count);
+    state.SetBytesProcessed(state.iterations() * corpus.size());
+}
+
+BENCHMARK(macro_tokenize<std_vector_of>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_tokenize<small_vector_of<4>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_tokenize<small_vector_of<8>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_tokenize<small_vector_of<16>>)->Unit(benchmark::kMillisecond);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+enum class opcode : uint32_t { constant, copy, unary, binary, select, phi };
+
+// The instructions of a program in an SSA-like intermediate representation, stored in a flat array. The operands
+// of each instruction refer to earlier instructions, mostly ones close to it.
+struct ir_program
+{
+    std::vector<opcode> opcodes;
+    std::vector<uint32_t> operand_offsets;
+    std::vector<uint32_t> operands;
+};
+
+static const ir_program& random_ir_program()
+{
+    static const ir_program program = []
+    {
+        constexpr uint32_t NODE_COUNT = 500'000;
+
+        std::mt19937_64 rng(SEED);
+        std::discrete_distribution<int> kind({ 20, 10, 20, 40, 8, 2 });
+        std::uniform_int_distribution<uint32_t> phi_operands(4, 16);
+        std::geometric_distribution<uint32_t> distance(0.1);
+
+        ir_program program;
+        program.operand_offsets.push_back(0);
+        for (uint32_t node = 0; node < NODE_COUNT; node++)
+        {
+            const opcode op = node == 0 ? opcode::constant : opcode(kind(rng));
+            const uint32_t operand_count = op == opcode::phi ? phi_operands(rng) : std::array{ 0u, 1u, 1u, 2u, 3u }[size_t(op)];
+
+            program.opcodes.push_back(op);
+            for (uint32_t i = 0; i < operand_count; i++)
+            {
+                program.operands.push_back(node - 1 - std::min(distance(rng), node - 1));
+            }
+            program.operand_offsets.push_back(uint32_t(program.operands.size()));
+        }
+        return program;
+    }();
+
+    return program;
+}
+
+template<typename VectorOf>
+struct ir_node
+{
+    opcode op;
+    typename VectorOf::template type<uint32_t> operands;
+};
+
+template<typename VectorOf>
+void macro_ir_passes(benchmark::State& state)
+{
+    const ir_program& program = random_ir_program();
+
+    scoped_peak_rss peak_rss(state);
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        std::vector<ir_node<VectorOf>> nodes;
+        for (size_t i = 0; i < program.opcodes.size(); i++)
+        {
+            ir_node<VectorOf>& node = nodes.emplace_back();
+            node.op = program.opcodes[i];
+            node.operands.assign(program.operands.begin() + program.operand_offsets[i], program.operands.begin() + program.operand_offsets[i + 1]);
+        }
+
+        // Copy propagation: replace the uses of copies with their sources
+        for (ir_node<VectorOf>& node : nodes)
+        {
+            for (uint32_t& operand : node.operands)
+            {
+                while (nodes[operand].op == opcode::copy) operand = nodes[operand].operands[0];
+            }
+        }
+
+        // Dead code elimination: remove the operands of the unused nodes, and of the nodes used only by them
+        std::vector<uint32_t> use_counts(nodes.size());
+        for (const ir_node<VectorOf>& node : nodes)
+        {
+            for (uint32_t operand : node.operands) use_counts[operand]++;
+        }
+        for (size_t i = nodes.size(); i-- > 1;)
+        {
+            if (use_counts[i] != 0) continue;
+            for (uint32_t operand : nodes[i].operands) use_counts[operand]--;
+            nodes[i].operands.clear();
+        }
+        benchmark::DoNotOptimize(nodes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * program.opcodes.size());
+}
+
+BENCHMARK(macro_ir_passes<std_vector_of>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_ir_passes<small_vector_of<2>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_ir_passes<small_vector_of<3>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_ir_passes<small_vector_of<4>>)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_ir_passes<small_vector_of<8>>)->Unit(benchmark::kMillisecond);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// A hash map using separate chaining, with the entries of each bucket stored in a vector.
+template<typename VectorOf>
+class chained_hash_map
+{
+public:
+    using value_type = std::pair<uint64_t, uint64_t>;
+
+    explicit chained_hash_map(size_t bucket_count) :
+        buckets_(std::bit_ceil(bucket_count))
+    {}
+
+    void insert(uint64_t key, uint64_t value)
+    {
+        auto& bucket = buckets_[bucket_of(key)];
+        for (value_type& entry : bucket)
+        {
+            if (entry.first == key) { entry.second = value; return; }
+        }
+        bucket.emplace_back(key, value);
+    }
+
+    const uint64_t* find(uint64_t key) const noexcept
+    {
+        for (const value_type& entry : buckets_[bucket_of(key)])
+        {
+            if (entry.first == key) return &entry.second;
+        }
+        return nullptr;
+    }
+
+private:
+    size_t bucket_of(uint64_t key) const noexcept
+    {
+        return size_t((key * 0x9e3779b97f4a7c15) >> 32) & (buckets_.size() - 1);
+    }
+
+    std::vector<typename VectorOf::template type<value_type>> buckets_;
+};
+
+template<typename VectorOf>
+void macro_hash_map(benchmark::State& state)
+{
+    constexpr size_t KEY_COUNT = 1 << 18;
+    const size_t load_factor = state.range(0);
+
+    std::mt19937_64 rng(SEED);
+    std::vector<uint64_t> keys(2 * KEY_COUNT);
+    for (uint64_t& key : keys) key = rng();
+
+    scoped_peak_rss peak_rss(state);
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        chained_hash_map<VectorOf> map(KEY_COUNT / load_factor);
+        for (size_t i = 0; i < KEY_COUNT; i++) map.insert(keys[i], i);
+
+        // Half of the lookups are for keys that are not in the map
+        uint64_t sum = 0;
+        for (uint64_t key : keys)
+        {
+            if (const uint64_t* value = map.find(key)) sum += *value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * (KEY_COUNT + keys.size()));
+}
+
+BENCHMARK(macro_hash_map<std_vector_of>)->ArgName("load_factor")->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_hash_map<small_vector_of<1>>)->ArgName("load_factor")->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_hash_map<small_vector_of<2>>)->ArgName("load_factor")->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_hash_map<small_vector_of<4>>)->ArgName("load_factor")->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(macro_hash_map<small_vector_of<8>>)->ArgName("load_factor")->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
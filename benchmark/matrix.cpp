@@ -0,0 +1,268 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// Benchmarks of the basic operations of small_vector across a matrix of element types, inline sizes and
+// vector sizes, compared with std::vector and optionally with boost::container::small_vector (SV_BENCHMARK_BOOST)
+// and absl::InlinedVector (SV_BENCHMARK_ABSL). The instrumented element types report the number of copies,
+// moves and destructions per iteration as counters.
+
+#include <benchmark/benchmark.h>
+#include <small_vector.hpp>
+#include "perf_counters.hpp"
+#include <vector>
+#include <memory>
+#include <string>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+#if SV_BENCHMARK_BOOST
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wstringop-overread" // false positives in the instantiations of boost::container::small_vector
+#endif
+#include <boost/container/small_vector.hpp>
+#endif
+
+#if SV_BENCHMARK_ABSL
+#include <absl/container/inlined_vector.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<size_t Bytes>
+struct pod
+{
+    static_assert(Bytes % sizeof(uint64_t) == 0);
+
+    std::array<uint64_t, Bytes / sizeof(uint64_t)> data;
+};
+
+// An element type with a pointer to itself, so it can't be relocated with memcpy (similar to std::string in libstdc++)
+struct self_referential
+{
+    self_referential(size_t i) : value(i), self(this) {}
+    self_referential(const self_referential& other) : value(other.value), self(this) {}
+    self_referential& operator=(const self_referential& other) { value = other.value; return *this; }
+
+    size_t value;
+    self_referential* self;
+};
+
+struct instrumented_counters
+{
+    size_t copies = 0;
+    size_t moves = 0;
+    size_t destructions = 0;
+};
+
+inline thread_local instrumented_counters counters;
+
+// An element type that counts the number of times it is copied, moved and destroyed.
+template<bool Relocatable>
+struct counted
+{
+    counted(size_t i) : value(i) {}
+    counted(const counted& other) : value(other.value) { counters.copies++; }
+    counted(counted&& other) noexcept : value(other.value) { counters.moves++; }
+    counted& operator=(const counted& other) { value = other.value; counters.copies++; return *this; }
+    counted& operator=(counted&& other) noexcept { value = other.value; counters.moves++; return *this; }
+    ~counted() { counters.destructions++; }
+
+    size_t value;
+};
+
+template<>
+struct is_trivially_relocatable<counted<true>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_counted_v = std::is_same_v<T, counted<true>> || std::is_same_v<T, counted<false>>;
+
+template<typename T>
+T make_value(size_t i)
+{
+    if constexpr (std::is_same_v<T, std::string>) return std::string(24, char('a' + i % 26));
+    else if constexpr (std::is_same_v<T, std::unique_ptr<size_t>>) return std::make_unique<size_t>(i);
+    else if constexpr (std::is_aggregate_v<T>) { T value{}; value.data[0] = i; return value; }
+    else return T(i);
+}
+
+template<typename V>
+V make_vector(size_t size)
+{
+    V vec;
+    for (size_t i = 0; i < size; i++) vec.push_back(make_value<typename V::value_type>(i));
+    return vec;
+}
+
+template<typename V>
+void report_counters(benchmark::State& state)
+{
+    if constexpr (is_counted_v<typename V::value_type>)
+    {
+        state.counters["copies"] = benchmark::Counter(double(counters.copies), benchmark::Counter::kAvgIterations);
+        state.counters["moves"] = benchmark::Counter(double(counters.moves), benchmark::Counter::kAvgIterations);
+        state.counters["destructions"] = benchmark::Counter(double(counters.destructions), benchmark::Counter::kAvgIterations);
+    }
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename V>
+void matrix_push_back(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    const size_t size = state.range(0);
+
+    counters = {};
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec;
+        for (size_t i = 0; i < size; i++) vec.push_back(make_value<T>(i));
+        benchmark::DoNotOptimize(vec.data());
+    }
+    measure.stop();
+    report_counters<V>(state);
+}
+
+template<typename V>
+void matrix_copy_construct(benchmark::State& state)
+{
+    const V source = make_vector<V>(state.range(0));
+
+    counters = {};
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec(source);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    measure.stop();
+    report_counters<V>(state);
+}
+
+template<typename V>
+void matrix_move_construct(benchmark::State& state)
+{
+    V source = make_vector<V>(state.range(0));
+
+    counters = {};
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec(std::move(source));
+        benchmark::DoNotOptimize(vec.data());
+        source = std::move(vec);
+    }
+    measure.stop();
+    report_counters<V>(state);
+}
+
+template<typename V>
+void matrix_insert_erase_front(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    V vec = make_vector<V>(state.range(0));
+
+    counters = {};
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        vec.insert(vec.begin(), make_value<T>(0));
+        benchmark::DoNotOptimize(vec.data());
+        vec.erase(vec.begin());
+        benchmark::DoNotOptimize(vec.data());
+    }
+    measure.stop();
+    report_counters<V>(state);
+}
+
+template<typename V>
+void matrix_swap(benchmark::State& state)
+{
+    V left = make_vector<V>(state.range(0));
+    V right = make_vector<V>(state.range(0));
+
+    counters = {};
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        left.swap(right);
+        benchmark::DoNotOptimize(left.data());
+        benchmark::DoNotOptimize(right.data());
+    }
+    measure.stop();
+    report_counters<V>(state);
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+inline constexpr size_t MAX_MATRIX_BYTES = 64 * 1024 * 1024;
+
+// The vector sizes around the inline capacity, and a few large sizes that are far from it.
+template<typename T>
+std::vector<int64_t> matrix_sizes(size_t inline_size)
+{
+    std::vector<int64_t> sizes;
+    for (size_t size : { inline_size - 1, inline_size, inline_size + 1, 2 * inline_size, size_t(1000), size_t(1'000'000) })
+    {
+        if (size == 0 || size * sizeof(T) > MAX_MATRIX_BYTES) continue;
+        if (sizes.empty() || int64_t(size) > sizes.back()) sizes.push_back(int64_t(size));
+    }
+    return sizes;
+}
+
+template<typename V>
+void register_operations(const std::string& name, const std::vector<int64_t>& sizes)
+{
+    using T = typename V::value_type;
+
+    auto add = [&](const char* operation, void (*fn)(benchmark::State&))
+    {
+        benchmark::RegisterBenchmark(("matrix_" + std::string(operation) + "<" + name + ">").c_str(), fn)->ArgName("size")->ArgsProduct({ sizes });
+    };
+
+    add("push_back", matrix_push_back<V>);
+    if constexpr (std::is_copy_constructible_v<T>) add("copy_construct", matrix_copy_construct<V>);
+    add("move_construct", matrix_move_construct<V>);
+    add("insert_erase_front", matrix_insert_erase_front<V>);
+    add("swap", matrix_swap<V>);
+}
+
+template<typename T, size_t Size>
+void register_containers(const std::string& type_name)
+{
+    const std::vector<int64_t> sizes = matrix_sizes<T>(Size);
+    const std::string size = std::to_string(Size);
+
+    register_operations<small_vector<T, Size>>("small_vector<" + type_name + ", " + size + ">", sizes);
+    register_operations<std::vector<T>>("std::vector<" + type_name + ">/inline:" + size, sizes);
+
+#if SV_BENCHMARK_BOOST
+    register_operations<boost::container::small_vector<T, Size>>("boost::small_vector<" + type_name + ", " + size + ">", sizes);
+#endif
+#if SV_BENCHMARK_ABSL
+    register_operations<absl::InlinedVector<T, Size>>("absl::InlinedVector<" + type_name + ", " + size + ">", sizes);
+#endif
+}
+
+template<typename T>
+void register_element_type(const std::string& type_name)
+{
+    register_containers<T, 4>(type_name);
+    register_containers<T, 16>(type_name);
+}
+
+[[maybe_unused]] static const bool matrix_registered = []
+{
+    register_element_type<std::string>("std::string");
+    register_element_type<std::unique_ptr<size_t>>("std::unique_ptr");
+    register_element_type<pod<16>>("pod<16>");
+    register_element_type<pod<64>>("pod<64>");
+    register_element_type<pod<256>>("pod<256>");
+    register_element_type<self_referential>("self_referential");
+    register_element_type<counted<false>>("counted");
+    register_element_type<counted<true>>("counted_relocatable");
+    return true;
+}();
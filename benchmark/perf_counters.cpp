@@ -0,0 +1,284 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+#include "perf_counters.hpp"
+#include <new>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#define SV_BENCHMARK_PERF_EVENT 1
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define SV_BENCHMARK_PERF_EVENT 0
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// The replacement allocation functions. The nothrow forms forward to these by default.
+
+// Prevent inlining free() into the deallocation functions, otherwise GCC warns about freeing memory returned by
+// operator new in the standard containers used in this file (-Wmismatched-new-delete)
+#if defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+static constinit thread_local allocation_counts allocations;
+
+static void* allocate_bytes(size_t size)
+{
+    allocations.allocs++;
+    allocations.bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+static void* allocate_aligned_bytes(size_t size, size_t alignment)
+{
+    allocations.allocs++;
+    allocations.bytes += size;
+#ifdef _MSC_VER
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+NOINLINE static void deallocate_bytes(void* p) noexcept
+{
+    if (!p) return;
+    allocations.frees++;
+    std::free(p);
+}
+
+NOINLINE static void deallocate_aligned_bytes(void* p) noexcept
+{
+    if (!p) return;
+    allocations.frees++;
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(size_t size)
+{
+    if (void* p = allocate_bytes(size)) return p;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size)
+{
+    if (void* p = allocate_bytes(size)) return p;
+    throw std::bad_alloc{};
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* p = allocate_aligned_bytes(size, size_t(alignment))) return p;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void* p = allocate_aligned_bytes(size, size_t(alignment))) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { deallocate_bytes(p); }
+void operator delete[](void* p) noexcept { deallocate_bytes(p); }
+void operator delete(void* p, size_t) noexcept { deallocate_bytes(p); }
+void operator delete[](void* p, size_t) noexcept { deallocate_bytes(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { deallocate_aligned_bytes(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { deallocate_aligned_bytes(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { deallocate_aligned_bytes(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { deallocate_aligned_bytes(p); }
+
+allocation_counts thread_allocation_counts() noexcept
+{
+    return allocations;
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+#if SV_BENCHMARK_PERF_EVENT
+
+static int open_event(uint32_t type, uint64_t config) noexcept
+{
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static constexpr uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result) noexcept
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+hardware_counters::hardware_counters() noexcept
+{
+    fds_[size_t(hardware_event::cycles)]        = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds_[size_t(hardware_event::instructions)]  = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds_[size_t(hardware_event::branch_misses)] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fds_[size_t(hardware_event::l1d_misses)]    = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+    fds_[size_t(hardware_event::llc_misses)]    = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+}
+
+hardware_counters::~hardware_counters() noexcept
+{
+    for (int fd : fds_) if (fd != -1) close(fd);
+}
+
+void hardware_counters::start() noexcept
+{
+    for (int fd : fds_)
+    {
+        if (fd == -1) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+hardware_counters::values_type hardware_counters::stop() noexcept
+{
+    for (int fd : fds_) if (fd != -1) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    values_type values{};
+    for (size_t i = 0; i < HARDWARE_EVENT_COUNT; i++)
+    {
+        struct { uint64_t value, time_enabled, time_running; } data{};
+        if (fds_[i] == -1 || read(fds_[i], &data, sizeof(data)) != sizeof(data)) continue;
+
+        // Scale the value if the event was multiplexed with other events and only counted for a part of the time
+        values[i] = data.time_running ? double(data.value) * (double(data.time_enabled) / double(data.time_running)) : 0.0;
+    }
+    return values;
+}
+
+#else // !SV_BENCHMARK_PERF_EVENT
+
+hardware_counters::hardware_counters() noexcept { fds_.fill(-1); }
+hardware_counters::~hardware_counters() noexcept {}
+void hardware_counters::start() noexcept {}
+hardware_counters::values_type hardware_counters::stop() noexcept { return {}; }
+
+#endif // SV_BENCHMARK_PERF_EVENT
+
+hardware_counters& hardware_counters::thread_counters() noexcept
+{
+    thread_local hardware_counters counters;
+    return counters;
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+scoped_counters::scoped_counters(benchmark::State& state) noexcept :
+    state_(state), hardware_(hardware_counters::thread_counters())
+{
+    allocations_ = thread_allocation_counts();
+    hardware_.start();
+}
+
+void scoped_counters::stop() noexcept
+{
+    if (std::exchange(stopped_, true)) return;
+
+    const hardware_counters::values_type events = hardware_.stop();
+    const allocation_counts allocations = thread_allocation_counts();
+
+    auto add = [&](const char* name, double value)
+    {
+        state_.counters[name] = benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+    };
+
+    static constexpr const char* event_names[] = { "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses" };
+
+    for (size_t i = 0; i < HARDWARE_EVENT_COUNT; i++)
+    {
+        if (hardware_.available(hardware_event(i))) add(event_names[i], events[i]);
+    }
+    if (hardware_.available(hardware_event::cycles) && hardware_.available(hardware_event::instructions))
+    {
+        const double cycles = events[size_t(hardware_event::cycles)];
+        state_.counters["ipc"] = cycles ? events[size_t(hardware_event::instructions)] / cycles : 0.0;
+    }
+
+    add("allocs", double(allocations.allocs - allocations_.allocs));
+    add("frees", double(allocations.frees - allocations_.frees));
+    add("allocated_bytes", double(allocations.bytes - allocations_.bytes));
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+#ifdef __linux__
+
+// Returns the value of a field of /proc/self/status in bytes, or 0 if it can't be read
+static size_t read_status_field(const char* field) noexcept
+{
+    std::FILE* file = std::fopen("/proc/self/status", "r");
+    if (!file) return 0;
+
+    size_t kbytes = 0;
+    char line[256];
+    while (std::fgets(line, sizeof(line), file))
+    {
+        if (std::strncmp(line, field, std::strlen(field)) != 0) continue;
+        std::sscanf(line + std::strlen(field), "%zu", &kbytes);
+        break;
+    }
+    std::fclose(file);
+
+    return 1024 * kbytes;
+}
+
+static void reset_peak_rss() noexcept
+{
+#ifdef __GLIBC__
+    malloc_trim(0); // release the memory freed by the previous benchmarks, so it doesn't count towards the baseline
+#endif
+    if (std::FILE* file = std::fopen("/proc/self/clear_refs", "w"))
+    {
+        std::fputs("5", file);
+        std::fclose(file);
+    }
+}
+
+scoped_peak_rss::scoped_peak_rss(benchmark::State& state) noexcept :
+    state_(state)
+{
+    reset_peak_rss();
+    baseline_ = read_status_field("VmRSS:");
+}
+
+scoped_peak_rss::~scoped_peak_rss() noexcept
+{
+    const size_t peak = read_status_field("VmHWM:");
+    if (!baseline_ || !peak) return;
+
+    state_.counters["peak_rss"] = benchmark::Counter(double(peak > baseline_ ? peak - baseline_ : 0), benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
+#else // !__linux__
+
+scoped_peak_rss::scoped_peak_rss(benchmark::State& state) noexcept : state_(state), baseline_(0) {}
+scoped_peak_rss::~scoped_peak_rss() noexcept {}
+
+#endif // __linux__
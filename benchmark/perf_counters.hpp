@@ -0,0 +1,97 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+#ifndef SMALL_VECTOR_BENCHMARK_PERF_COUNTERS_HPP
+#define SMALL_VECTOR_BENCHMARK_PERF_COUNTERS_HPP
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The number of calls to the global operator new and operator delete, and the number of bytes allocated by the
+// calling thread. The counts are maintained by the replacement allocation functions in perf_counters.cpp.
+struct allocation_counts
+{
+    uint64_t allocs = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;
+};
+
+allocation_counts thread_allocation_counts() noexcept;
+
+enum class hardware_event : size_t
+{
+    cycles,
+    instructions,
+    branch_misses,
+    l1d_misses,
+    llc_misses
+};
+
+inline constexpr size_t HARDWARE_EVENT_COUNT = 5;
+
+// A set of hardware performance counters of the calling thread, read using perf_event_open on Linux. Events
+// that can't be opened (unsupported platform, missing PMU in a virtual machine, or a restrictive
+// perf_event_paranoid setting) are silently left out, so the benchmarks still run without them.
+class hardware_counters
+{
+public:
+    using values_type = std::array<double, HARDWARE_EVENT_COUNT>;
+
+    hardware_counters() noexcept;
+    ~hardware_counters() noexcept;
+
+    hardware_counters(const hardware_counters&) = delete;
+    hardware_counters& operator=(const hardware_counters&) = delete;
+
+    bool available(hardware_event event) const noexcept { return fds_[size_t(event)] != -1; }
+
+    void start() noexcept;
+    values_type stop() noexcept;
+
+    static hardware_counters& thread_counters() noexcept;
+
+private:
+    std::array<int, HARDWARE_EVENT_COUNT> fds_;
+};
+
+// Measures the hardware events and the allocations from its construction until stop() is called or it is destroyed,
+// and reports them as per-iteration counters of the benchmark. It should be constructed right before the benchmark
+// loop, after any setup code that shouldn't be included in the measurements.
+class scoped_counters
+{
+public:
+    explicit scoped_counters(benchmark::State& state) noexcept;
+    ~scoped_counters() noexcept { stop(); }
+
+    scoped_counters(const scoped_counters&) = delete;
+    scoped_counters& operator=(const scoped_counters&) = delete;
+
+    void stop() noexcept;
+
+private:
+    benchmark::State& state_;
+    hardware_counters& hardware_;
+    allocation_counts allocations_;
+    bool stopped_ = false;
+};
+
+// Measures the peak resident set size of the process from its construction until its destruction, and reports the
+// growth of it over the resident set size at construction as the peak_rss counter of the benchmark. This includes
+// every allocation made during this time, including the ones made outside of the benchmark loop. Only supported
+// on Linux, the counter is not reported on other platforms.
+class scoped_peak_rss
+{
+public:
+    explicit scoped_peak_rss(benchmark::State& state) noexcept;
+    ~scoped_peak_rss() noexcept;
+
+    scoped_peak_rss(const scoped_peak_rss&) = delete;
+    scoped_peak_rss& operator=(const scoped_peak_rss&) = delete;
+
+private:
+    benchmark::State& state_;
+    size_t baseline_;
+};
+
+#endif // !SMALL_VECTOR_BENCHMARK_PERF_COUNTERS_HPP
@@ -0,0 +1,129 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// Benchmarks of modifying a small_vector through a size-erased small_vector_ref, compared with modifying it directly
+// in a function that is templated on the inline capacity of the vector. The functions are not inlined into the
+// benchmarks, similar to utility functions shared by many call sites. The difference in code size between the two
+// approaches is measured by the small_vector_ref_code_size target (see ref_code_size.cpp).
+
+#include <benchmark/benchmark.h>
+#include <small_vector.hpp>
+#include "perf_counters.hpp"
+#include <string>
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename T>
+T make_value(size_t i)
+{
+    if constexpr (std::is_same_v<T, std::string>) return std::string(24, char('a' + i % 26));
+    else return T(i);
+}
+
+template<typename T, size_t Size>
+NOINLINE void append_direct(small_vector<T, Size>& vec, size_t count)
+{
+    for (size_t i = 0; i < count; i++) vec.push_back(make_value<T>(i));
+}
+
+template<typename T>
+NOINLINE void append_ref(small_vector_ref<T> vec, size_t count)
+{
+    for (size_t i = 0; i < count; i++) vec.push_back(make_value<T>(i));
+}
+
+template<typename T, size_t Size>
+NOINLINE void insert_erase_front_direct(small_vector<T, Size>& vec)
+{
+    vec.insert(vec.begin(), make_value<T>(0));
+    vec.erase(vec.begin());
+}
+
+template<typename T>
+NOINLINE void insert_erase_front_ref(small_vector_ref<T> vec)
+{
+    vec.insert(vec.begin(), make_value<T>(0));
+    vec.erase(vec.begin());
+}
+
+template<typename T, size_t Size>
+NOINLINE void resize_direct(small_vector<T, Size>& vec, size_t count)
+{
+    vec.resize(count);
+    vec.resize(0);
+}
+
+template<typename T>
+NOINLINE void resize_ref(small_vector_ref<T> vec, size_t count)
+{
+    vec.resize(count);
+    vec.resize(0);
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename T, size_t Size, bool UseRef>
+void benchmark_ref_append(benchmark::State& state)
+{
+    const size_t count = state.range(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        small_vector<T, Size> vec;
+        if constexpr (UseRef) append_ref<T>(vec, count);
+        else append_direct(vec, count);
+        benchmark::DoNotOptimize(vec.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+template<typename T, size_t Size, bool UseRef>
+void benchmark_ref_insert_erase_front(benchmark::State& state)
+{
+    small_vector<T, Size> vec;
+    for (size_t i = 0; i < size_t(state.range(0)); i++) vec.push_back(make_value<T>(i));
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        if constexpr (UseRef) insert_erase_front_ref<T>(vec);
+        else insert_erase_front_direct(vec);
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+template<typename T, size_t Size, bool UseRef>
+void benchmark_ref_resize(benchmark::State& state)
+{
+    const size_t count = state.range(0);
+    small_vector<T, Size> vec;
+    vec.reserve(count);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        if constexpr (UseRef) resize_ref<T>(vec, count);
+        else resize_direct(vec, count);
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+BENCHMARK(benchmark_ref_append<int, 8, false>)->Name("benchmark_ref_append<int, 8>/direct")->ArgName("size")->Arg(4)->Arg(100);
+BENCHMARK(benchmark_ref_append<int, 8, true>)->Name("benchmark_ref_append<int, 8>/ref")->ArgName("size")->Arg(4)->Arg(100);
+BENCHMARK(benchmark_ref_append<std::string, 4, false>)->Name("benchmark_ref_append<std::string, 4>/direct")->ArgName("size")->Arg(4)->Arg(100);
+BENCHMARK(benchmark_ref_append<std::string, 4, true>)->Name("benchmark_ref_append<std::string, 4>/ref")->ArgName("size")->Arg(4)->Arg(100);
+
+BENCHMARK(benchmark_ref_insert_erase_front<int, 8, false>)->Name("benchmark_ref_insert_erase_front<int, 8>/direct")->ArgName("size")->Arg(4)->Arg(100);
+BENCHMARK(benchmark_ref_insert_erase_front<int, 8, true>)->Name("benchmark_ref_insert_erase_front<int, 8>/ref")->ArgName("size")->Arg(4)->Arg(100);
+BENCHMARK(benchmark_ref_insert_erase_front<std::string, 4, false>)->Name("benchmark_ref_insert_erase_front<std::string, 4>/direct")->ArgName("size")->Arg(4)->Arg(100);
+BENCHMARK(benchmark_ref_insert_erase_front<std::string, 4, true>)->Name("benchmark_ref_insert_erase_front<std::string, 4>/ref")->ArgName("size")->Arg(4)->Arg(100);
+
+BENCHMARK(benchmark_ref_resize<int, 8, false>)->Name("benchmark_ref_resize<int, 8>/direct")->ArgName("size")->Arg(4)->Arg(100);
+BENCHMARK(benchmark_ref_resize<int, 8, true>)->Name("benchmark_ref_resize<int, 8>/ref")->ArgName("size")->Arg(4)->Arg(100);
@@ -0,0 +1,97 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// A translation unit with a few utility functions that modify small vectors, called with vectors of CALLER_COUNT
+// different inline capacities. It is compiled twice by the small_vector_ref_code_size target: with SV_CODE_SIZE_USE_REF=0
+// the utility functions are templates over the inline capacity of the vector, which are instantiated for every capacity,
+// with SV_CODE_SIZE_USE_REF=1 they take a small_vector_ref, so there is only one instance of each of them.
+// The target reports the size of the two object files.
+
+#include <small_vector.hpp>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+#ifndef SV_CODE_SIZE_USE_REF
+#define SV_CODE_SIZE_USE_REF 0
+#endif
+
+#if SV_CODE_SIZE_USE_REF
+#define UTILITY_TEMPLATE
+#define INT_VECTOR small_vector_ref<int>
+#define STRING_VECTOR small_vector_ref<std::string>
+#else
+#define UTILITY_TEMPLATE template<size_t Size>
+#define INT_VECTOR small_vector<int, Size>&
+#define STRING_VECTOR small_vector<std::string, Size>&
+#endif
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+UTILITY_TEMPLATE
+void split_words(STRING_VECTOR words, std::string_view text)
+{
+    size_t first = 0;
+    while (first < text.size())
+    {
+        const size_t last = std::min(text.find(' ', first), text.size());
+        if (last != first) words.emplace_back(text.substr(first, last - first));
+        first = last + 1;
+    }
+}
+
+UTILITY_TEMPLATE
+void insert_sorted(INT_VECTOR values, int value)
+{
+    values.insert(std::upper_bound(values.begin(), values.end(), value), value);
+}
+
+UTILITY_TEMPLATE
+void remove_adjacent_duplicates(INT_VECTOR values)
+{
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+UTILITY_TEMPLATE
+void pad_words(STRING_VECTOR words, size_t count)
+{
+    words.reserve(count);
+    words.resize(count, std::string("-"));
+}
+
+UTILITY_TEMPLATE
+void append_range(INT_VECTOR values, int first, int last)
+{
+    for (int i = first; i < last; i++) values.push_back(i);
+}
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+inline constexpr size_t CALLER_COUNT = 8;
+
+template<size_t Size>
+size_t call_utilities(std::string_view text)
+{
+    small_vector<std::string, Size> words;
+    small_vector<int, Size> values;
+
+    split_words(words, text);
+    pad_words(words, 2 * words.size());
+    append_range(values, 0, int(words.size()));
+    insert_sorted(values, 3);
+    remove_adjacent_duplicates(values);
+
+    return words.size() + values.size();
+}
+
+template<size_t... Is>
+size_t call_all(std::string_view text, std::index_sequence<Is...>)
+{
+    return (call_utilities<Is + 1>(text) + ...);
+}
+
+size_t code_size_entry(std::string_view text)
+{
+    return call_all(text, std::make_index_sequence<CALLER_COUNT>{});
+}
@@ -1,7 +1,20 @@
 #include <benchmark/benchmark.h>
 #include <small_vector.hpp>
+#include <small_vector_stats.hpp>
+#include <small_vector_serialization.hpp>
+#include "perf_counters.hpp"
 #include <vector>
+#include <unordered_map>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <span>
 #include <string>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
 
 inline constexpr size_t SMALL_SIZE = 4;
 inline constexpr size_t LARGE_SIZE = 100;
@@ -13,6 +26,7 @@ void benchmark_construct_from_size(benchmark::State& state)
 {
     size_t size = state.range(0);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         benchmark::DoNotOptimize(size);
@@ -33,6 +47,7 @@ void benchmark_construct_from_size_value(benchmark::State& state)
     size_t size = state.range(0);
     int value = 2;
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         benchmark::DoNotOptimize(size);
@@ -53,6 +68,7 @@ void benchmark_construct_from_range(benchmark::State& state)
 {
     V src(state.range(0), 0);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         benchmark::DoNotOptimize(src);
@@ -75,6 +91,7 @@ void benchmark_assign_reserved(benchmark::State& state)
     V src(size, 1);
     V dst(size, 2);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         benchmark::DoNotOptimize(src);
@@ -102,6 +119,7 @@ void benchmark_swap(benchmark::State& state)
     V left(size, 1);
     V right(size, 2);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         using std::swap;
@@ -115,6 +133,95 @@ void benchmark_swap(benchmark::State& state)
 BENCHMARK(benchmark_swap<std::vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
 BENCHMARK(benchmark_swap<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
 
+template<typename V>
+void benchmark_swap_mixed(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    V left(size, 1);
+    V right(2 * V::inline_capacity(), 2);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        using std::swap;
+        swap(left, right);
+        benchmark::DoNotOptimize(left);
+        benchmark::DoNotOptimize(right);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(benchmark_swap<small_vector<int, 2>>)->ArgName("size")->Arg(1)->Arg(2);
+BENCHMARK(benchmark_swap<small_vector<int, 8>>)->ArgName("size")->Arg(1)->Arg(SMALL_SIZE)->Arg(8);
+BENCHMARK(benchmark_swap<small_vector<int, 32>>)->ArgName("size")->Arg(1)->Arg(SMALL_SIZE)->Arg(32);
+BENCHMARK(benchmark_swap<small_vector<int, 128>>)->ArgName("size")->Arg(1)->Arg(SMALL_SIZE)->Arg(128);
+BENCHMARK(benchmark_swap_mixed<small_vector<int, 8>>)->ArgName("size")->Arg(1)->Arg(8);
+BENCHMARK(benchmark_swap_mixed<small_vector<int, 32>>)->ArgName("size")->Arg(1)->Arg(32);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename V>
+void benchmark_copy_construct(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    V source(size, 1);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(source);
+        V vec(source);
+        benchmark::DoNotOptimize(vec);
+    }
+}
+
+template<typename V>
+void benchmark_move_construct(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    V source(size, 1);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec(std::move(source));
+        benchmark::DoNotOptimize(vec);
+        source = std::move(vec);
+        benchmark::DoNotOptimize(source);
+    }
+}
+
+template<typename V>
+void benchmark_move_assign(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    V left(size, 1);
+    V right;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        right = std::move(left);
+        benchmark::DoNotOptimize(right);
+        left = std::move(right);
+        benchmark::DoNotOptimize(left);
+    }
+}
+
+BENCHMARK(benchmark_copy_construct<small_vector<int, 4>>)->ArgName("size")->Arg(1)->Arg(4);
+BENCHMARK(benchmark_copy_construct<small_vector<int, 16>>)->ArgName("size")->Arg(1)->Arg(8)->Arg(16);
+BENCHMARK(benchmark_copy_construct<small_vector<int, 64>>)->ArgName("size")->Arg(1)->Arg(32)->Arg(64);
+BENCHMARK(benchmark_move_construct<small_vector<int, 4>>)->ArgName("size")->Arg(1)->Arg(4);
+BENCHMARK(benchmark_move_construct<small_vector<int, 16>>)->ArgName("size")->Arg(1)->Arg(8)->Arg(16);
+BENCHMARK(benchmark_move_construct<small_vector<int, 64>>)->ArgName("size")->Arg(1)->Arg(32)->Arg(64);
+BENCHMARK(benchmark_move_assign<small_vector<int, 4>>)->ArgName("size")->Arg(1)->Arg(4);
+BENCHMARK(benchmark_move_assign<small_vector<int, 16>>)->ArgName("size")->Arg(1)->Arg(8)->Arg(16);
+BENCHMARK(benchmark_move_assign<small_vector<int, 64>>)->ArgName("size")->Arg(1)->Arg(32)->Arg(64);
+
 /* ----------------------------------------------------------------------------------------------------------- */
 
 template<typename V>
@@ -124,6 +231,7 @@ void benchmark_resize(benchmark::State& state)
 
     V vec(size);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         benchmark::DoNotOptimize(size);
@@ -143,6 +251,52 @@ BENCHMARK(benchmark_resize<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)
 
 /* ----------------------------------------------------------------------------------------------------------- */
 
+inline constexpr size_t HUGE_SIZE = 1'000'000;
+
+template<typename V>
+void benchmark_construct_default_init(benchmark::State& state)
+{
+    size_t size = state.range(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(size);
+        V vec(size, default_init);
+        benchmark::DoNotOptimize(vec.data());
+        benchmark::ClobberMemory();
+    }
+}
+
+template<typename V>
+void benchmark_resize_for_overwrite(benchmark::State& state)
+{
+    size_t size = state.range(0);
+
+    V vec(size);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(size);
+
+        vec.resize(0);
+        benchmark::DoNotOptimize(vec);
+
+        vec.resize_for_overwrite(size);
+        benchmark::DoNotOptimize(vec);
+
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(benchmark_construct_from_size<small_vector<int>>)->ArgName("size")->Arg(HUGE_SIZE);
+BENCHMARK(benchmark_construct_default_init<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE)->Arg(HUGE_SIZE);
+BENCHMARK(benchmark_resize<small_vector<int>>)->ArgName("size")->Arg(HUGE_SIZE);
+BENCHMARK(benchmark_resize_for_overwrite<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE)->Arg(HUGE_SIZE);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
 template<typename V>
 void benchmark_push_back_reserved(benchmark::State& state)
 {
@@ -150,6 +304,7 @@ void benchmark_push_back_reserved(benchmark::State& state)
 
     V vec(size + 1);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         vec.pop_back();
@@ -173,6 +328,7 @@ void benchmark_push_back_reallocate(benchmark::State& state)
     const size_t final_size = state.range(0);
     const size_t start_size = small_vector<int>::inline_capacity();
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         V vec(start_size);
@@ -198,6 +354,7 @@ void benchmark_insert_one_reserved(benchmark::State& state)
 
     V vec(size + 1, 1);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         vec.pop_back();
@@ -221,6 +378,7 @@ void benchmark_insert_one_reallocate(benchmark::State& state)
     const size_t final_size = state.range(0);
     const size_t start_size = small_vector<int>::inline_capacity();
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         V vec(start_size);
@@ -247,6 +405,7 @@ void benchmark_insert_range_reserved(benchmark::State& state)
     V vec(size + 3, 1);
     V rng = { 1, 2, 3 };
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         benchmark::DoNotOptimize(rng);
@@ -274,6 +433,7 @@ void benchmark_insert_range_reallocate(benchmark::State& state)
 
     V rng = { 1, 2, 3 };
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         V vec(start_size);
@@ -300,6 +460,7 @@ void benchmark_erase(benchmark::State& state)
 
     V vec(size, 1);
 
+    scoped_counters measure(state);
     for (auto _ : state)
     {
         vec.erase(vec.begin());
@@ -312,3 +473,990 @@ void benchmark_erase(benchmark::State& state)
 
 BENCHMARK(benchmark_erase<std::vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
 BENCHMARK(benchmark_erase<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename V>
+void benchmark_sizeof(benchmark::State& state)
+{
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec;
+        benchmark::DoNotOptimize(vec);
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["sizeof"] = sizeof(V);
+}
+
+BENCHMARK(benchmark_sizeof<small_vector<int, 2>>);
+BENCHMARK(benchmark_sizeof<compact_small_vector<int, 2>>);
+BENCHMARK(benchmark_sizeof<small_vector<int, 12>>);
+BENCHMARK(benchmark_sizeof<compact_small_vector<int, 12>>);
+BENCHMARK(benchmark_sizeof<small_vector<int>>);
+BENCHMARK(benchmark_sizeof<compact_small_vector<int>>);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename V>
+void benchmark_iterate_many(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+    const size_t count = 1 << 16;
+
+    std::vector<V> vecs(count, V(size, 1));
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        int sum = 0;
+        for (const V& vec : vecs)
+        {
+            for (int elem : vec) sum += elem;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count * size);
+    state.counters["sizeof"] = sizeof(V);
+}
+
+BENCHMARK(benchmark_iterate_many<small_vector<int, 12>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_iterate_many<compact_small_vector<int, 12>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+struct cache_line_options : small_vector_options { using alignment = cache_line_alignment; };
+struct packed_options : small_vector_options { using alignment = packed_alignment; };
+
+template<typename T, size_t N>
+using cache_line_small_vector = small_vector<T, N, std::allocator<T>, cache_line_options>;
+
+template<typename T, size_t N>
+using packed_small_vector = small_vector<T, N, std::allocator<T>, packed_options>;
+
+template<typename V>
+void benchmark_density(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+    const size_t count = 1 << 16;
+
+    std::vector<V> vecs(count, V(size, 1));
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        size_t sum = 0;
+        for (const V& vec : vecs)
+        {
+            for (auto elem : vec) sum += elem;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["sizeof"] = sizeof(V);
+    state.counters["inline_capacity"] = V::inline_capacity();
+}
+
+BENCHMARK(benchmark_density<small_vector<char, 6>>)->ArgName("size")->Arg(2)->Arg(6);
+BENCHMARK(benchmark_density<cache_line_small_vector<char, 6>>)->ArgName("size")->Arg(2)->Arg(6);
+BENCHMARK(benchmark_density<packed_small_vector<char, 6>>)->ArgName("size")->Arg(2)->Arg(6);
+BENCHMARK(benchmark_density<small_vector<int>>)->ArgName("size")->Arg(2)->Arg(SMALL_SIZE);
+BENCHMARK(benchmark_density<cache_line_small_vector<int, detail::default_small_size_v<int>>>)->ArgName("size")->Arg(2)->Arg(SMALL_SIZE);
+BENCHMARK(benchmark_density<small_vector<double, 3>>)->ArgName("size")->Arg(2)->Arg(3);
+BENCHMARK(benchmark_density<cache_line_small_vector<double, 3>>)->ArgName("size")->Arg(2)->Arg(3);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename Growth>
+struct growth_options : small_vector_options { using growth = Growth; };
+
+template<typename Growth>
+using growth_small_vector = small_vector<int, detail::default_small_size_v<int>, std::allocator<int>, growth_options<Growth>>;
+
+template<typename V>
+void benchmark_push_back_growth(benchmark::State& state)
+{
+    const size_t final_size = state.range(0);
+    size_t reallocations = 0;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec;
+        reallocations = 0;
+
+        for (size_t i = 0; i < final_size; i++)
+        {
+            const auto old_capacity = vec.capacity();
+            benchmark::DoNotOptimize(vec);
+            vec.push_back(static_cast<int>(i));
+            reallocations += (vec.capacity() != old_capacity);
+            benchmark::ClobberMemory();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * final_size);
+    state.counters["reallocations"] = double(reallocations);
+}
+
+BENCHMARK(benchmark_push_back_growth<std::vector<int>>)->ArgName("size")->Arg(LARGE_SIZE)->Arg(10000);
+BENCHMARK(benchmark_push_back_growth<growth_small_vector<growth_factor_1_5>>)->ArgName("size")->Arg(LARGE_SIZE)->Arg(10000);
+BENCHMARK(benchmark_push_back_growth<growth_small_vector<growth_factor_2>>)->ArgName("size")->Arg(LARGE_SIZE)->Arg(10000);
+BENCHMARK(benchmark_push_back_growth<growth_small_vector<power_of_two_growth>>)->ArgName("size")->Arg(LARGE_SIZE)->Arg(10000);
+BENCHMARK(benchmark_push_back_growth<growth_small_vector<exact_growth>>)->ArgName("size")->Arg(LARGE_SIZE)->Arg(10000);
+BENCHMARK(benchmark_push_back_growth<growth_small_vector<first_spill_growth<64, growth_factor_2>>>)->ArgName("size")->Arg(LARGE_SIZE)->Arg(10000);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename V>
+void benchmark_grow_to_bytes(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    const size_t final_size = state.range(0) / sizeof(T);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec;
+
+        for (size_t i = 0; i < final_size; i++)
+        {
+            vec.push_back(T(i));
+        }
+
+        benchmark::DoNotOptimize(vec.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * final_size * sizeof(T));
+}
+
+inline constexpr int64_t KB = 1024;
+inline constexpr int64_t MB = 1024 * KB;
+
+BENCHMARK(benchmark_grow_to_bytes<std::vector<int64_t>>)->ArgName("bytes")->Arg(KB)->Arg(MB)->Arg(100 * MB);
+BENCHMARK(benchmark_grow_to_bytes<small_vector<int64_t>>)->ArgName("bytes")->Arg(KB)->Arg(MB)->Arg(100 * MB);
+BENCHMARK(benchmark_grow_to_bytes<small_vector<int64_t, 4, malloc_allocator<int64_t>>>)->ArgName("bytes")->Arg(KB)->Arg(MB)->Arg(100 * MB);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename V>
+void benchmark_insert_erase_front(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    const size_t size = state.range(0);
+
+    V vec;
+    for (size_t i = 0; i < size; i++) vec.push_back(std::make_unique<typename T::element_type>());
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        vec.insert(vec.begin(), std::move(vec.back()));
+        vec.pop_back();
+        benchmark::DoNotOptimize(vec.data());
+
+        vec.erase(vec.begin());
+        vec.emplace_back(std::make_unique<typename T::element_type>());
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+BENCHMARK(benchmark_insert_erase_front<std::vector<std::unique_ptr<int>>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_insert_erase_front<small_vector<std::unique_ptr<int>>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+
+template<typename V>
+void benchmark_swap_relocatable(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    V left, right;
+    for (size_t i = 0; i < size; i++) left.push_back(std::make_unique<int>(int(i)));
+    right.push_back(std::make_unique<int>(0));
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        left.swap(right);
+        benchmark::DoNotOptimize(left.data());
+        benchmark::DoNotOptimize(right.data());
+    }
+}
+
+BENCHMARK(benchmark_swap_relocatable<small_vector<std::unique_ptr<int>, 8>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(8);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename V>
+void benchmark_append_transform_iterators(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+    const std::vector<int> src(size, 1);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        auto view = src | std::views::transform([](int i) { return 2 * i; });
+        V vec;
+        vec.insert(vec.end(), view.begin(), view.end());
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+template<typename V>
+void benchmark_append_transform_range(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+    const std::vector<int> src(size, 1);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec;
+        vec.append_range(src | std::views::transform([](int i) { return 2 * i; }));
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+template<typename V>
+void benchmark_append_take_iterators(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        auto view = std::views::iota(0) | std::views::take(size) | std::views::common;
+        V vec;
+        vec.insert(vec.end(), view.begin(), view.end());
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+template<typename V>
+void benchmark_append_take_range(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec;
+        vec.append_range(std::views::iota(0) | std::views::take(size));
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+template<typename V>
+void benchmark_assign_contiguous_range(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+    const std::vector<int> src(size, 1);
+
+    V vec;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        vec.assign_range(src);
+        benchmark::DoNotOptimize(vec.data());
+    }
+}
+
+BENCHMARK(benchmark_append_transform_iterators<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_append_transform_range<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_append_take_iterators<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_append_take_range<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_assign_contiguous_range<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// The percentage of elements removed is given by the selectivity argument
+template<typename V>
+void benchmark_erase_if(benchmark::State& state)
+{
+    using T = typename V::value_type;
+
+    const size_t size = 10000;
+    const int selectivity = int(state.range(0));
+
+    V source;
+    for (size_t i = 0; i < size; i++) source.push_back(T((i * 7919) % 100));
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        V vec(source);
+        const auto erased = erase_if(vec, [&](T elem) { return elem < T(selectivity); });
+        benchmark::DoNotOptimize(erased);
+        benchmark::DoNotOptimize(vec.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(benchmark_erase_if<std::vector<int>>)->ArgName("selectivity")->Arg(0)->Arg(10)->Arg(50)->Arg(90)->Arg(100);
+BENCHMARK(benchmark_erase_if<small_vector<int>>)->ArgName("selectivity")->Arg(0)->Arg(10)->Arg(50)->Arg(90)->Arg(100);
+BENCHMARK(benchmark_erase_if<std::vector<double>>)->ArgName("selectivity")->Arg(0)->Arg(10)->Arg(50)->Arg(90)->Arg(100);
+BENCHMARK(benchmark_erase_if<small_vector<double>>)->ArgName("selectivity")->Arg(0)->Arg(10)->Arg(50)->Arg(90)->Arg(100);
+
+template<typename V>
+void benchmark_erase_unordered(benchmark::State& state)
+{
+    const size_t size = state.range(0);
+
+    V vec(size, 1);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        vec.erase_unordered(vec.begin() + size / 2);
+        benchmark::DoNotOptimize(vec);
+
+        vec.push_back(1);
+        benchmark::DoNotOptimize(vec);
+    }
+}
+
+BENCHMARK(benchmark_erase_unordered<small_vector<int>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// The position of the searched element is given as a percentage of the size, 100 means that it's not in the vector
+template<typename V>
+V make_find_input(benchmark::State& state)
+{
+    using T = typename V::value_type;
+
+    const size_t size = state.range(0);
+    const size_t position = size * state.range(1) / 100;
+
+    V vec;
+    for (size_t i = 0; i < size; i++) vec.push_back(T(i % 100 + 1));
+    if (position < size) vec[position] = T(0);
+
+    return vec;
+}
+
+template<typename V>
+void benchmark_std_find(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    const V vec = make_find_input<V>(state);
+    T value = T(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(std::find(vec.begin(), vec.end(), value));
+    }
+}
+
+template<typename V>
+void benchmark_find(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    const V vec = make_find_input<V>(state);
+    T value = T(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(vec.find(value));
+    }
+}
+
+template<typename V>
+void benchmark_std_count(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    const V vec = make_find_input<V>(state);
+    T value = T(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(std::count(vec.begin(), vec.end(), value));
+    }
+}
+
+template<typename V>
+void benchmark_count(benchmark::State& state)
+{
+    using T = typename V::value_type;
+    const V vec = make_find_input<V>(state);
+    T value = T(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(value);
+        benchmark::DoNotOptimize(vec.count(value));
+    }
+}
+
+BENCHMARK(benchmark_std_find<std::vector<int>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 4, 16, 100, 1000 }, { 0, 50, 100 } });
+BENCHMARK(benchmark_std_find<small_vector<int, 16>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 4, 16, 100, 1000 }, { 0, 50, 100 } });
+BENCHMARK(benchmark_find<small_vector<int, 16>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 4, 16, 100, 1000 }, { 0, 50, 100 } });
+BENCHMARK(benchmark_std_find<std::vector<uint8_t>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 16, 64, 1000 }, { 50, 100 } });
+BENCHMARK(benchmark_find<small_vector<uint8_t, 64>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 16, 64, 1000 }, { 50, 100 } });
+BENCHMARK(benchmark_std_find<std::vector<double>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 4, 8, 100, 1000 }, { 50, 100 } });
+BENCHMARK(benchmark_find<small_vector<double, 8>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 4, 8, 100, 1000 }, { 50, 100 } });
+
+BENCHMARK(benchmark_std_count<std::vector<int>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 4, 16, 100, 1000 }, { 50 } });
+BENCHMARK(benchmark_count<small_vector<int, 16>>)->ArgNames({ "size", "position" })->ArgsProduct({ { 4, 16, 100, 1000 }, { 50 } });
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// The position of the first difference between the vectors is given as a percentage of the size,
+// 100 means that the vectors are equal
+template<typename V>
+std::pair<V, V> make_comparison_input(benchmark::State& state)
+{
+    using T = typename V::value_type;
+
+    const size_t size = state.range(0);
+    const size_t position = size * state.range(1) / 100;
+
+    V lhs;
+    for (size_t i = 0; i < size; i++) lhs.push_back(T(i % 100 + 1));
+
+    V rhs = lhs;
+    if (position < size) rhs[position] = T(0);
+
+    return { std::move(lhs), std::move(rhs) };
+}
+
+template<typename V>
+void benchmark_equal(benchmark::State& state)
+{
+    auto [lhs, rhs] = make_comparison_input<V>(state);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(rhs);
+        benchmark::DoNotOptimize(lhs == rhs);
+    }
+}
+
+template<typename V>
+void benchmark_three_way_compare(benchmark::State& state)
+{
+    auto [lhs, rhs] = make_comparison_input<V>(state);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(rhs);
+        benchmark::DoNotOptimize(lhs <=> rhs);
+    }
+}
+
+BENCHMARK(benchmark_equal<std::vector<int>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 8, 100, 1000 }, { 0, 90, 100 } });
+BENCHMARK(benchmark_equal<small_vector<int, 8>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 8, 100, 1000 }, { 0, 90, 100 } });
+BENCHMARK(benchmark_equal<std::vector<uint64_t*>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 8, 100 }, { 0, 90, 100 } });
+BENCHMARK(benchmark_equal<small_vector<uint64_t*, 8>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 8, 100 }, { 0, 90, 100 } });
+
+BENCHMARK(benchmark_three_way_compare<std::vector<uint8_t>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 16, 100, 1000 }, { 0, 90, 100 } });
+BENCHMARK(benchmark_three_way_compare<small_vector<uint8_t, 16>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 16, 100, 1000 }, { 0, 90, 100 } });
+BENCHMARK(benchmark_three_way_compare<std::vector<int>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 8, 100, 1000 }, { 0, 90, 100 } });
+BENCHMARK(benchmark_three_way_compare<small_vector<int, 8>>)->ArgNames({ "size", "mismatch" })->ArgsProduct({ { 8, 100, 1000 }, { 0, 90, 100 } });
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+// The usual hash_combine based hash for std::vector, which doesn't have a std::hash specialization
+template<typename V>
+struct vector_hash
+{
+    size_t operator()(const V& vec) const noexcept
+    {
+        if constexpr (requires { std::hash<V>{}; }) return std::hash<V>{}(vec);
+        else
+        {
+            size_t seed = vec.size();
+            for (const auto& elem : vec) seed ^= std::hash<typename V::value_type>{}(elem) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    }
+};
+
+template<typename V>
+std::vector<V> make_hash_keys(size_t count, size_t key_size)
+{
+    using T = typename V::value_type;
+
+    std::vector<V> keys(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = 0; j < key_size; j++)
+        {
+            const size_t value = (i * 2654435761u + j * 40503u) % 1000003;
+            if constexpr (std::is_same_v<T, std::string>) keys[i].push_back(std::to_string(value));
+            else keys[i].push_back(T(value));
+        }
+    }
+    return keys;
+}
+
+template<typename V>
+void benchmark_hash(benchmark::State& state)
+{
+    const V vec = make_hash_keys<V>(1, state.range(0)).front();
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(vec);
+        benchmark::DoNotOptimize(vector_hash<V>{}(vec));
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(typename V::value_type));
+}
+
+template<typename V>
+void benchmark_hash_map_insert(benchmark::State& state)
+{
+    const std::vector<V> keys = make_hash_keys<V>(state.range(0), state.range(1));
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        std::unordered_map<V, size_t, vector_hash<V>> map;
+        map.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) map.emplace(keys[i], i);
+        benchmark::DoNotOptimize(map);
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template<typename V>
+void benchmark_hash_map_find(benchmark::State& state)
+{
+    const std::vector<V> keys = make_hash_keys<V>(state.range(0), state.range(1));
+
+    std::unordered_map<V, size_t, vector_hash<V>> map;
+    for (size_t i = 0; i < keys.size(); i++) map.emplace(keys[i], i);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        size_t sum = 0;
+        for (const V& key : keys) sum += map.find(key)->second;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+BENCHMARK(benchmark_hash<std::vector<uint32_t>>)->ArgName("size")->Arg(1)->Arg(4)->Arg(8)->Arg(32)->Arg(1000);
+BENCHMARK(benchmark_hash<small_vector<uint32_t, 8>>)->ArgName("size")->Arg(1)->Arg(4)->Arg(8)->Arg(32)->Arg(1000);
+BENCHMARK(benchmark_hash<std::vector<std::string>>)->ArgName("size")->Arg(4)->Arg(32);
+BENCHMARK(benchmark_hash<small_vector<std::string, 8>>)->ArgName("size")->Arg(4)->Arg(32);
+
+BENCHMARK(benchmark_hash_map_insert<std::vector<uint32_t>>)->ArgNames({ "keys", "key_size" })->ArgsProduct({ { 1000, 100'000 }, { 2, 8, 32 } });
+BENCHMARK(benchmark_hash_map_insert<small_vector<uint32_t, 8>>)->ArgNames({ "keys", "key_size" })->ArgsProduct({ { 1000, 100'000 }, { 2, 8, 32 } });
+BENCHMARK(benchmark_hash_map_find<std::vector<uint32_t>>)->ArgNames({ "keys", "key_size" })->ArgsProduct({ { 1000, 100'000 }, { 2, 8, 32 } });
+BENCHMARK(benchmark_hash_map_find<small_vector<uint32_t, 8>>)->ArgNames({ "keys", "key_size" })->ArgsProduct({ { 1000, 100'000 }, { 2, 8, 32 } });
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+inline constexpr size_t REQUEST_FIELDS = 64;
+
+// Simulates a request processing loop, where every request creates a number of short lived vectors
+// of different sizes (between 1 and max_size), some of which spill to the heap.
+template<typename V>
+void benchmark_request_loop(benchmark::State& state)
+{
+    const size_t max_size = state.range(0);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        arena_scope scope;
+        V fields[REQUEST_FIELDS];
+
+        for (size_t i = 0; i < REQUEST_FIELDS; i++)
+        {
+            const size_t size = i * 7 % max_size + 1;
+            for (size_t j = 0; j < size; j++) fields[i].emplace_back();
+        }
+
+        benchmark::DoNotOptimize(fields);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(benchmark_request_loop<small_vector<int, 8>>)->ArgName("max_size")->Arg(8)->Arg(32)->Arg(256);
+BENCHMARK(benchmark_request_loop<small_vector<int, 8, arena_allocator<int>>>)->ArgName("max_size")->Arg(8)->Arg(32)->Arg(256);
+BENCHMARK(benchmark_request_loop<small_vector<std::string, 8>>)->ArgName("max_size")->Arg(8)->Arg(32)->Arg(256);
+BENCHMARK(benchmark_request_loop<small_vector<std::string, 8, arena_allocator<std::string>>>)->ArgName("max_size")->Arg(8)->Arg(32)->Arg(256);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename Stats>
+struct stats_options : small_vector_options { using stats = Stats; };
+
+template<typename Stats>
+using stats_small_vector = small_vector<int, 8, std::allocator<int>, stats_options<Stats>>;
+
+// A policy with an empty record function, so the hooks are instantiated, but they should be optimized out
+struct empty_stats
+{
+    template<typename Vector>
+    static void record(stats_event, const stats_params&) noexcept {}
+};
+
+// The no_stats policy removes the hooks, it must have no overhead compared to the hooks of a policy that does nothing.
+// The small_vector_stats_code_size target compares the generated code of the same policies.
+BENCHMARK(benchmark_push_back_reallocate<stats_small_vector<no_stats>>)->ArgName("size")->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_push_back_reallocate<stats_small_vector<empty_stats>>)->ArgName("size")->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_push_back_reallocate<stats_small_vector<counting_stats<>>>)->ArgName("size")->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_request_loop<stats_small_vector<no_stats>>)->ArgName("max_size")->Arg(32);
+BENCHMARK(benchmark_request_loop<stats_small_vector<empty_stats>>)->ArgName("max_size")->Arg(32);
+BENCHMARK(benchmark_request_loop<stats_small_vector<counting_stats<>>>)->ArgName("max_size")->Arg(32);
+BENCHMARK(benchmark_request_loop<stats_small_vector<sampling_stats<>>>)->ArgName("max_size")->Arg(32);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+template<typename Resource>
+void benchmark_pmr_request_loop(benchmark::State& state)
+{
+    using V = small_vector_pmr::small_vector<int, 8>;
+
+    const size_t max_size = state.range(0);
+    Resource resource;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        {
+            std::pmr::vector<V> fields(REQUEST_FIELDS, &resource);
+
+            for (size_t i = 0; i < REQUEST_FIELDS; i++)
+            {
+                const size_t size = i * 7 % max_size + 1;
+                for (size_t j = 0; j < size; j++) fields[i].emplace_back();
+            }
+
+            benchmark::DoNotOptimize(fields.data());
+            benchmark::ClobberMemory();
+        }
+        if constexpr (std::is_same_v<Resource, std::pmr::monotonic_buffer_resource>) resource.release();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Resource>
+void benchmark_pmr_move_assign(benchmark::State& state)
+{
+    using V = small_vector_pmr::small_vector<int, 8>;
+
+    const size_t size = state.range(0);
+    Resource resource;
+
+    V left(size, 1, &resource);
+    V right(&resource);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        right = std::move(left);
+        benchmark::DoNotOptimize(right);
+        left = std::move(right);
+        benchmark::DoNotOptimize(left);
+    }
+}
+
+template<typename Resource>
+void benchmark_pmr_swap(benchmark::State& state)
+{
+    using V = small_vector_pmr::small_vector<int, 8>;
+
+    const size_t size = state.range(0);
+    Resource resource;
+
+    V left(size, 1, &resource);
+    V right(size, 2, &resource);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        left.swap(right);
+        benchmark::DoNotOptimize(left);
+        benchmark::DoNotOptimize(right);
+    }
+}
+
+BENCHMARK(benchmark_pmr_request_loop<std::pmr::monotonic_buffer_resource>)->ArgName("max_size")->Arg(8)->Arg(32)->Arg(256);
+BENCHMARK(benchmark_pmr_request_loop<std::pmr::unsynchronized_pool_resource>)->ArgName("max_size")->Arg(8)->Arg(32)->Arg(256);
+BENCHMARK(benchmark_pmr_request_loop<std::pmr::synchronized_pool_resource>)->ArgName("max_size")->Arg(8)->Arg(32)->Arg(256);
+
+BENCHMARK(benchmark_move_assign<small_vector<int, 8>>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_pmr_move_assign<std::pmr::monotonic_buffer_resource>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_pmr_move_assign<std::pmr::unsynchronized_pool_resource>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_pmr_move_assign<std::pmr::synchronized_pool_resource>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+
+BENCHMARK(benchmark_swap<small_vector<int, 8>>)->ArgName("size")->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_pmr_swap<std::pmr::monotonic_buffer_resource>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_pmr_swap<std::pmr::unsynchronized_pool_resource>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+BENCHMARK(benchmark_pmr_swap<std::pmr::synchronized_pool_resource>)->ArgName("size")->Arg(SMALL_SIZE)->Arg(LARGE_SIZE);
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+
+// Reads a file through a pipe into a vector, using a different method to append the data to the vector
+template<typename V, typename ReadChunk>
+void benchmark_read_pipe(benchmark::State& state, ReadChunk read_chunk)
+{
+    const size_t file_size = state.range(0);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "small_vector_benchmark_read_pipe.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        const std::string data(file_size, 'x');
+        file.write(data.data(), std::streamsize(data.size()));
+    }
+    const std::string command = "cat '" + path.string() + "'";
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        FILE* pipe = ::popen(command.c_str(), "r");
+        const int fd = ::fileno(pipe);
+
+        V vec;
+        while (read_chunk(vec, fd) > 0) {}
+        benchmark::DoNotOptimize(vec.data());
+
+        ::pclose(pipe);
+    }
+
+    std::filesystem::remove(path);
+    state.SetBytesProcessed(state.iterations() * file_size);
+}
+
+inline constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+
+template<typename V>
+void benchmark_read_pipe_resize(benchmark::State& state)
+{
+    benchmark_read_pipe<V>(state, [](V& vec, int fd)
+    {
+        const size_t old_size = vec.size();
+        vec.resize(old_size + READ_CHUNK_SIZE);
+        const ssize_t count = ::read(fd, vec.data() + old_size, READ_CHUNK_SIZE);
+        vec.resize(old_size + size_t(std::max<ssize_t>(count, 0)));
+        return count;
+    });
+}
+
+template<typename V>
+void benchmark_read_pipe_append_uninitialized(benchmark::State& state)
+{
+    benchmark_read_pipe<V>(state, [](V& vec, int fd)
+    {
+        std::span<char> tail = vec.append_uninitialized(READ_CHUNK_SIZE);
+        const ssize_t count = ::read(fd, tail.data(), tail.size());
+        vec.commit(size_t(std::max<ssize_t>(count, 0)));
+        return count;
+    });
+}
+
+template<typename V>
+void benchmark_read_pipe_resize_and_overwrite(benchmark::State& state)
+{
+    benchmark_read_pipe<V>(state, [](V& vec, int fd)
+    {
+        ssize_t count = 0;
+        vec.resize_and_overwrite(vec.size() + READ_CHUNK_SIZE, [&](char* data, size_t size)
+        {
+            const size_t old_size = size - READ_CHUNK_SIZE;
+            count = ::read(fd, data + old_size, READ_CHUNK_SIZE);
+            return old_size + size_t(std::max<ssize_t>(count, 0));
+        });
+        return count;
+    });
+}
+
+BENCHMARK(benchmark_read_pipe_resize<std::vector<char>>)->ArgName("bytes")->Arg(64 * MB);
+BENCHMARK(benchmark_read_pipe_resize<small_vector<char>>)->ArgName("bytes")->Arg(64 * MB);
+BENCHMARK(benchmark_read_pipe_append_uninitialized<small_vector<char>>)->ArgName("bytes")->Arg(64 * MB);
+BENCHMARK(benchmark_read_pipe_resize_and_overwrite<small_vector<char>>)->ArgName("bytes")->Arg(64 * MB);
+
+#endif // __has_include(<unistd.h>)
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+struct serialized_record
+{
+    uint64_t id;
+    double value;
+    uint32_t flags;
+    uint32_t count;
+};
+
+template<typename T>
+small_vector<T, 8> make_serialization_input(size_t size)
+{
+    small_vector<T, 8> vec;
+    for (size_t i = 0; i < size; i++)
+    {
+        if constexpr (std::is_same_v<T, serialized_record>) vec.push_back({ i, double(i), uint32_t(i), uint32_t(i) });
+        else vec.push_back(T(i));
+    }
+    return vec;
+}
+
+// The baseline: the vector is written to a stream one element at a time
+template<typename T>
+void benchmark_serialize_stream_per_element(benchmark::State& state)
+{
+    const auto vec = make_serialization_input<T>(state.range(0));
+    std::stringstream stream;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        stream.seekp(0);
+        const uint64_t size = vec.size();
+        stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        for (const T& elem : vec) stream.write(reinterpret_cast<const char*>(&elem), sizeof(T));
+        benchmark::DoNotOptimize(stream);
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+template<typename T>
+void benchmark_serialize_stream(benchmark::State& state)
+{
+    const auto vec = make_serialization_input<T>(state.range(0));
+    std::stringstream stream;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        stream.seekp(0);
+        write_to(vec, stream);
+        benchmark::DoNotOptimize(stream);
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+// The baseline: the vector is copied into a byte buffer one element at a time, and read back the same way
+template<typename T>
+void benchmark_serialize_buffer_per_element(benchmark::State& state)
+{
+    const auto vec = make_serialization_input<T>(state.range(0));
+    std::vector<std::byte> buffer(serialized_size(vec));
+    small_vector<T, 8> result;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        std::byte* out = buffer.data();
+        const uint64_t size = vec.size();
+        std::memcpy(out, &size, sizeof(size));
+        out += sizeof(size);
+        for (const T& elem : vec) { std::memcpy(out, &elem, sizeof(T)); out += sizeof(T); }
+        benchmark::DoNotOptimize(buffer.data());
+
+        const std::byte* in = buffer.data();
+        uint64_t read_size;
+        std::memcpy(&read_size, in, sizeof(read_size));
+        in += sizeof(read_size);
+        result.clear();
+        for (uint64_t i = 0; i < read_size; i++) { T elem; std::memcpy(&elem, in, sizeof(T)); in += sizeof(T); result.push_back(elem); }
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+template<typename T>
+void benchmark_serialize_buffer(benchmark::State& state)
+{
+    const auto vec = make_serialization_input<T>(state.range(0));
+    std::vector<std::byte> buffer(serialized_size(vec));
+    small_vector<T, 8> result;
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        write_to(vec, std::span(buffer));
+        benchmark::DoNotOptimize(buffer.data());
+        read_from(result, std::span<const std::byte>(buffer));
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.SetBytesProcessed(state.iterations() * vec.size() * sizeof(T));
+}
+
+BENCHMARK(benchmark_serialize_stream_per_element<int>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+BENCHMARK(benchmark_serialize_stream<int>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+BENCHMARK(benchmark_serialize_stream_per_element<serialized_record>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+BENCHMARK(benchmark_serialize_stream<serialized_record>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+
+BENCHMARK(benchmark_serialize_buffer_per_element<int>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+BENCHMARK(benchmark_serialize_buffer<int>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+BENCHMARK(benchmark_serialize_buffer_per_element<serialized_record>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+BENCHMARK(benchmark_serialize_buffer<serialized_record>)->ArgName("size")->Arg(8)->Arg(1000)->Arg(100'000);
+
+#if __has_include(<sys/mman.h>) && __has_include(<fcntl.h>)
+#include <sys/mman.h>
+#include <fcntl.h>
+
+// Sums the elements of a vector serialized to a file, either by reading it into a vector or by using a view into
+// the memory mapped file.
+template<bool UseView>
+void benchmark_read_serialized_file(benchmark::State& state)
+{
+    const auto vec = make_serialization_input<serialized_record>(state.range(0));
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "small_vector_benchmark_serialized.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        write_to(vec, file);
+    }
+    const size_t file_size = serialized_size(vec);
+
+    scoped_counters measure(state);
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        if constexpr (UseView)
+        {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            void* data = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+
+            for (const serialized_record& record : serialized_view<serialized_record>({ static_cast<const std::byte*>(data), file_size })) sum += record.id;
+
+            ::munmap(data, file_size);
+        }
+        else
+        {
+            std::ifstream file(path, std::ios::binary);
+            small_vector<serialized_record, 8> result;
+            read_from(result, file);
+
+            for (const serialized_record& record : result) sum += record.id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    std::filesystem::remove(path);
+    state.SetBytesProcessed(state.iterations() * file_size);
+}
+
+BENCHMARK(benchmark_read_serialized_file<false>)->Name("benchmark_read_serialized_file<read_from>")->ArgName("size")->Arg(1000)->Arg(1'000'000);
+BENCHMARK(benchmark_read_serialized_file<true>)->Name("benchmark_read_serialized_file<serialized_view>")->ArgName("size")->Arg(1000)->Arg(1'000'000);
+
+#endif // __has_include(<sys/mman.h>)
@@ -0,0 +1,15 @@
+# Reports the sizes of the object files of the small_vector_stats_code_size target.
+# Usage: cmake -D NO_STATS_OBJECT=<path> -D EMPTY_STATS_OBJECT=<path> -D COUNTING_STATS_OBJECT=<path> [-D SIZE_TOOL=<path>] -P stats_code_size.cmake
+
+file(SIZE "${NO_STATS_OBJECT}" no_stats_size)
+file(SIZE "${EMPTY_STATS_OBJECT}" empty_stats_size)
+file(SIZE "${COUNTING_STATS_OBJECT}" counting_stats_size)
+
+message(STATUS "Object file size with no_stats:         ${no_stats_size} bytes")
+message(STATUS "Object file size with empty_stats:      ${empty_stats_size} bytes")
+message(STATUS "Object file size with counting_stats:   ${counting_stats_size} bytes")
+
+# The object files also contain the symbol tables and relocations, the size tool reports the size of the code only
+if(SIZE_TOOL)
+    execute_process(COMMAND "${SIZE_TOOL}" "${NO_STATS_OBJECT}" "${EMPTY_STATS_OBJECT}" "${COUNTING_STATS_OBJECT}")
+endif()
@@ -0,0 +1,82 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// A translation unit with a few functions that allocate, reallocate and free the storage of small vectors. It is
+// compiled by the small_vector_stats_code_size target with each of the statistics policies selected by SV_STATS_POLICY:
+//
+//  - 0: no_stats, the hooks are removed from the vector,
+//  - 1: empty_stats, a policy with an empty record function, so the hooks are instantiated and must be optimized out,
+//  - 2: counting_stats, the hooks record every event.
+//
+// The target reports the size of the object files. The code of the first two should be the same size, which shows
+// that the hooks don't leave any code behind when they are disabled.
+
+#include <small_vector.hpp>
+#include <small_vector_stats.hpp>
+#include <algorithm>
+#include <cstddef>
+
+#ifndef SV_STATS_POLICY
+#define SV_STATS_POLICY 0
+#endif
+
+struct empty_stats
+{
+    template<typename Vector>
+    static void record(stats_event, const stats_params&) noexcept {}
+};
+
+struct code_size_options : small_vector_options
+{
+#if SV_STATS_POLICY == 0
+    using stats = no_stats;
+#elif SV_STATS_POLICY == 1
+    using stats = empty_stats;
+#else
+    using stats = counting_stats<>;
+#endif
+};
+
+using int_vector = small_vector<int, 8, std::allocator<int>, code_size_options>;
+
+/* ----------------------------------------------------------------------------------------------------------- */
+
+int_vector make_range(int count)
+{
+    int_vector values;
+    for (int i = 0; i < count; i++) values.push_back(i);
+    return values;
+}
+
+int_vector make_filled(size_t count, int value)
+{
+    return int_vector(count, value);
+}
+
+void insert_front(int_vector& values, const int_vector& other)
+{
+    values.insert(values.begin(), other.begin(), other.end());
+    values.insert(values.begin(), 0);
+}
+
+void replace(int_vector& values, const int_vector& other)
+{
+    values = other;
+}
+
+void compact(int_vector& values)
+{
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    values.shrink_to_fit();
+}
+
+size_t code_size_entry(int count)
+{
+    int_vector values = make_range(count);
+    int_vector other = make_filled(size_t(count), 1);
+
+    insert_front(values, other);
+    compact(values);
+    replace(other, values);
+
+    return values.size() + other.size();
+}
@@ -0,0 +1,65 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// The small_vector named module. It provides the same interface as small_vector.hpp, but importing it doesn't parse
+// the header and its standard library dependencies again in every translation unit. The macros of the header
+// (e.g. SV_NO_SIMD) are not exported, they have to be defined when the module itself is compiled.
+
+module;
+
+#include "small_vector.hpp"
+
+export module small_vector;
+
+export
+{
+    using ::is_trivially_relocatable;
+    using ::is_trivially_relocatable_v;
+
+    using ::malloc_allocator;
+    using ::bump_arena;
+    using ::arena_scope;
+    using ::arena_allocator;
+
+    using ::pointer_layout;
+    using ::compact_layout;
+    using ::natural_alignment;
+    using ::cache_line_alignment;
+    using ::packed_alignment;
+
+    using ::growth_params;
+    using ::geometric_growth;
+    using ::growth_factor_1_5;
+    using ::growth_factor_2;
+    using ::power_of_two_growth;
+    using ::exact_growth;
+    using ::first_spill_growth;
+
+    using ::shrink_params;
+    using ::no_shrink;
+    using ::hysteresis_shrink;
+
+    using ::stats_event;
+    using ::stats_params;
+    using ::no_stats;
+
+    using ::small_vector_options;
+    using ::compact_small_vector_options;
+
+    using ::default_init_t;
+    using ::default_init;
+
+    using ::small_vector;
+    using ::compact_small_vector;
+    using ::small_vector_ref;
+
+    using ::swap;
+    using ::erase;
+    using ::erase_if;
+}
+
+export namespace small_vector_pmr
+{
+    using small_vector_pmr::small_vector;
+    using small_vector_pmr::compact_small_vector;
+
+} // namespace small_vector_pmr
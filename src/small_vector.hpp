@@ -6,20 +6,73 @@
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <ranges>
+#include <span>
 #include <initializer_list>
 #include <memory>
+#include <memory_resource>
+#include <string>
 #include <new>
 #include <type_traits>
 #include <utility>
+#include <limits>
+#include <concepts>
+#include <bit>
 #include <stdexcept>
 #include <cstdlib>
+#include <cstring>
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 
 #if defined(_MSC_VER)
 #   define SV_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#   define SV_NOINLINE __declspec(noinline)
 #else
 #   define SV_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#   define SV_NOINLINE __attribute__((noinline))
+#endif
+
+// The vectorized algorithms are only used with GCC and Clang on x86-64, since they rely on the target attribute to
+// compile the functions for instruction sets that are selected at runtime. They can be disabled by defining SV_NO_SIMD.
+#if !defined(SV_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#   define SV_X86_SIMD 1
+#   define SV_TARGET(isa) __attribute__((target(isa)))
+#   include <immintrin.h>
+#else
+#   define SV_X86_SIMD 0
+#endif
+
+//----------------------------------------- TRIVIAL RELOCATION ------------------------------------------------------
+
+// The type 'T' is trivially relocatable if moving an object of type T into uninitialized memory and then destroying
+// the source object is equivalent to calling memcpy() and not destroying the source object.
+// By default, this is only assumed for types with trivial move operations and destructors, but the trait can be
+// specialized for other types that satisfy this requirement (e.g. types that hold a pointer to a heap allocation).
+template<typename T>
+struct is_trivially_relocatable :
+    std::conjunction<std::is_trivially_move_constructible<T>, std::is_trivially_move_assignable<T>, std::is_trivially_destructible<T>>
+{};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template<typename T, typename D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>> : is_trivially_relocatable<D> {};
+
+template<typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template<typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+template<typename T, typename U>
+struct is_trivially_relocatable<std::pair<T, U>> : std::conjunction<is_trivially_relocatable<T>, is_trivially_relocatable<U>> {};
+
+#if defined(_LIBCPP_VERSION) || defined(_MSVC_STL_VERSION)
+// The libstdc++ implementation of basic_string stores a pointer to its own internal buffer, so it isn't relocatable
+template<typename CharT, typename Traits>
+struct is_trivially_relocatable<std::basic_string<CharT, Traits, std::allocator<CharT>>> : std::true_type {};
 #endif
 
 namespace detail
@@ -73,8 +126,24 @@ namespace detail
     template<typename Allocator, typename T, typename... Args>
     concept has_construct_method = requires { std::declval<Allocator>().construct(std::declval<T*>(), std::declval<Args>()...); };
 
+    template<typename T>
+    inline constexpr bool is_pair_v = false;
+
+    template<typename T, typename U>
+    inline constexpr bool is_pair_v<std::pair<T, U>> = true;
+
+    // The construct method of polymorphic_allocator only differs from calling the constructor of T
+    // directly if T uses the allocator (uses-allocator construction), or T is a pair.
+    template<typename Allocator, typename T>
+    inline constexpr bool is_pmr_trivial_construct_v = false;
+
+    template<typename U, typename T>
+    inline constexpr bool is_pmr_trivial_construct_v<std::pmr::polymorphic_allocator<U>, T> =
+        !std::uses_allocator_v<std::remove_cv_t<T>, std::pmr::polymorphic_allocator<U>> && !is_pair_v<std::remove_cv_t<T>>;
+
     template<typename Allocator, typename T, typename... Args>
-    inline constexpr bool has_trivial_construct_v = !has_construct_method<Allocator, T, Args...>;
+    inline constexpr bool has_trivial_construct_v = is_pmr_trivial_construct_v<std::remove_cvref_t<Allocator>, T> ||
+        !has_construct_method<Allocator, T, Args...>;
 
     // 'Allocator' has a trivial destroy method for the type 'T' if calling
     // allocator_traits<Allocator>::destroy is equivalent to directly calling the
@@ -82,19 +151,58 @@ namespace detail
     template<typename Allocator, typename T>
     concept has_destroy_method = requires { std::declval<Allocator>().destroy(std::declval<T*>()); };
 
+    template<typename Allocator>
+    inline constexpr bool is_pmr_allocator_v = false;
+
+    template<typename U>
+    inline constexpr bool is_pmr_allocator_v<std::pmr::polymorphic_allocator<U>> = true;
+
     template<typename Allocator, typename T>
-    inline constexpr bool has_trivial_destroy_v = !has_destroy_method<Allocator, T>;
+    inline constexpr bool has_trivial_destroy_v = is_pmr_allocator_v<std::remove_cvref_t<Allocator>> || !has_destroy_method<Allocator, T>;
 
 
-    // The type 'T' is considered trivially relocatable if its move construction and move assignment
-    // can be replaced with memcpy()/memmove().
     template<typename T>
-    struct is_trivially_relocatable :
-        std::conjunction<std::is_trivially_move_constructible<T>, std::is_trivially_move_assignable<T>, std::is_trivially_destructible<T>>
-    {};
+    inline constexpr bool is_trivially_relocatable_v = ::is_trivially_relocatable<std::remove_cv_t<T>>::value;
 
-    template<typename T>
-    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+    // The elements of type 'T' stored using 'Allocator' can be relocated using memcpy()/memmove(), without
+    // calling the move constructor and the destructor of T through the allocator.
+    template<typename Allocator, typename T>
+    inline constexpr bool memcpy_relocatable_v = is_trivially_relocatable_v<T> &&
+        has_trivial_construct_v<Allocator&, T, T&&> && has_trivial_destroy_v<Allocator&, T>;
+
+    // The elements of type 'T' stored using 'Allocator' can be left uninitialized, and written to directly.
+    template<typename Allocator, typename T>
+    inline constexpr bool can_leave_uninitialized_v = std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T> &&
+        has_trivial_construct_v<Allocator&, T> && has_trivial_destroy_v<Allocator&, T>;
+
+
+    // 'Allocator' can resize an existing allocation, possibly without moving it, by calling
+    // allocator.reallocate(data, old_count, new_count). The contents of the allocation are
+    // preserved as if by memcpy(), and the old allocation is unchanged if the call throws.
+    template<typename Allocator>
+    concept has_reallocate_method = requires(Allocator& alloc, alloc_pointer_t<Allocator> data, alloc_size_t<Allocator> count)
+    {
+        { alloc.reallocate(data, count, count) } -> std::same_as<alloc_pointer_t<Allocator>>;
+    };
+
+    // The storage of the elements of type 'T' can be resized using the reallocate method of 'Allocator'.
+    template<typename Allocator, typename T>
+    inline constexpr bool can_reallocate_v = has_reallocate_method<Allocator> && memcpy_relocatable_v<Allocator, T>;
+
+
+    // 'Allocator' has an allocate_at_least(count) method returning the allocated pointer and the number
+    // of elements that fit in it. This is used even when the standard library doesn't support allocate_at_least yet.
+    template<typename Allocator>
+    concept has_allocate_at_least_method = requires(Allocator& alloc, alloc_size_t<Allocator> count)
+    {
+        { alloc.allocate_at_least(count).ptr } -> std::convertible_to<alloc_pointer_t<Allocator>>;
+        { alloc.allocate_at_least(count).count } -> std::convertible_to<std::size_t>;
+    };
+
+    // 'Allocator' has a deallocate method that doesn't release anything (e.g. a monotonic arena), so
+    // the calls to it can be skipped, and there is no point in shrinking heap allocations made with it.
+    template<typename Allocator>
+    concept has_trivial_deallocate = requires { requires Allocator::trivial_deallocate::value; };
 
 
     template<typename Allocator>
@@ -119,23 +227,41 @@ namespace detail
     template<typename A>
     struct alloc_result_t { alloc_pointer_t<A> data; std::size_t size; };
 
+    // Allocate storage for at least count elements. The size of the returned allocation never exceeds max_count (the
+    // largest capacity the layout of the vector can represent), so it can always be deallocated with the same size.
     template<typename T, typename A>
-    constexpr alloc_result_t<A> allocate(A& allocator, alloc_size_t<A> count) requires(!has_allocate_at_least)
+    constexpr alloc_result_t<A> allocate(A& allocator, alloc_size_t<A> count, std::size_t) requires(!has_allocate_at_least && !has_allocate_at_least_method<A>)
     {
         return { std::allocator_traits<A>::allocate(allocator, count), count };
     }
 
     template<typename T, typename A>
-    constexpr alloc_result_t<A> allocate(A& allocator, alloc_size_t<A> count) requires(has_allocate_at_least)
+    constexpr alloc_result_t<A> allocate(A& allocator, alloc_size_t<A> count, std::size_t max_count) requires(has_allocate_at_least || has_allocate_at_least_method<A>)
     {
-        auto [data, size] = std::allocator_traits<A>::allocate_at_least(allocator, count);
-        return { data, size };
+        alloc_result_t<A> result;
+        if constexpr (has_allocate_at_least)
+        {
+            auto [data, size] = std::allocator_traits<A>::allocate_at_least(allocator, count);
+            result = { data, size };
+        }
+        else
+        {
+            auto [data, size] = allocator.allocate_at_least(count);
+            result = { data, size };
+        }
+
+        if (result.size > max_count) [[unlikely]]
+        {
+            std::allocator_traits<A>::deallocate(allocator, result.data, result.size);
+            result = { std::allocator_traits<A>::allocate(allocator, count), count };
+        }
+        return result;
     }
 
     template<typename A>
     constexpr void deallocate(A& allocator, alloc_pointer_t<A> data, alloc_size_t<A> count) noexcept
     {
-        std::allocator_traits<A>::deallocate(allocator, data, count);
+        if constexpr (!has_trivial_deallocate<A>) std::allocator_traits<A>::deallocate(allocator, data, count);
     }
 
     //--------------------------- CONSTRUCT / DESTROY ONE IN UNINITIALIZED MEMORY ---------------------------------------
@@ -209,6 +335,23 @@ namespace detail
         guard.release();
     }
 
+    template<typename R, typename T>
+    concept container_compatible_range = std::ranges::input_range<R> && std::convertible_to<std::ranges::range_reference_t<R>, T>;
+
+
+    // default construct, but leave trivial objects uninitialized
+    template<typename T, typename A>
+    constexpr void default_init_range(A& allocator, T* first, T* last)
+    noexcept(std::is_nothrow_default_constructible_v<T> && has_trivial_construct_v<A&, T>)
+    {
+        if constexpr (std::is_trivially_default_constructible_v<T> && has_trivial_construct_v<A&, T>)
+        {
+            if (!std::is_constant_evaluated()) return;
+        }
+
+        detail::construct_range(allocator, first, last);
+    }
+
     // copy construct
     template<typename T, typename A>
     constexpr void construct_range(A& allocator, T* first, T* last, const T& val)
@@ -243,12 +386,17 @@ namespace detail
         guard.release();
     }
 
+    // The relocate_range functions move construct the elements of a range into uninitialized memory. For trivially
+    // relocatable types, the objects are copied with memcpy(), so the source range must not be destroyed afterwards,
+    // and the destination range must not be destroyed if the operation is rolled back. Use destroy_relocated_range
+    // instead of destroy_range for these ranges.
+
     // move construct from another range if noexcept
     template<typename T, typename A>
     constexpr void relocate_range_strong(A& allocator, T* first, T* last, T* dest)
     noexcept(std::is_nothrow_move_constructible_v<T> && has_trivial_construct_v<A&, T, T&&>)
     {
-        if constexpr (is_trivially_relocatable_v<T> && has_trivial_construct_v<A&, T, T&&>)
+        if constexpr (memcpy_relocatable_v<A, T>)
         {
             if (!std::is_constant_evaluated())
             {
@@ -268,7 +416,7 @@ namespace detail
     constexpr void relocate_range_weak(A& allocator, T* first, T* last, T* dest)
     noexcept(std::is_nothrow_move_constructible_v<T> && has_trivial_construct_v<A&, T, T&&>)
     {
-        if constexpr (is_trivially_relocatable_v<T> && has_trivial_construct_v<A&, T, T&&>)
+        if constexpr (memcpy_relocatable_v<A, T>)
         {
             if (!std::is_constant_evaluated())
             {
@@ -283,13 +431,50 @@ namespace detail
         guard.release();
     }
 
+    // destroy the source range after it was relocated, or the destination range of a relocation that is rolled back
+    template<typename T, typename A>
+    constexpr void destroy_relocated_range(A& allocator, T* first, T* last) noexcept
+    {
+        if constexpr (memcpy_relocatable_v<A, T>)
+        {
+            if (!std::is_constant_evaluated()) return;
+        }
+
+        detail::destroy_range(allocator, first, last);
+    }
+
+    // Rotate the elements in the range [first, last) so that middle becomes the first element, without
+    // calling the move constructors and assignment operators of the elements. T must be trivially relocatable.
+    template<typename T>
+    void rotate_relocatable(T* first, T* middle, T* last) noexcept
+    {
+        constexpr std::size_t max_buffer_size = 256;
+
+        if (first == middle || middle == last) return;
+
+        const std::size_t head_size = sizeof(T) * std::size_t(middle - first);
+        const std::size_t tail_size = sizeof(T) * std::size_t(last - middle);
+
+        if (tail_size <= max_buffer_size)
+        {
+            alignas(T) unsigned char buffer[max_buffer_size];
+            std::memcpy(buffer, (void*)middle, tail_size);
+            std::memmove((unsigned char*)first + tail_size, (void*)first, head_size);
+            std::memcpy((void*)first, buffer, tail_size);
+        }
+        else
+        {
+            std::rotate((unsigned char*)first, (unsigned char*)middle, (unsigned char*)last);
+        }
+    }
+
     //---------------------------------------- ASSIGNMENT METHODS -------------------------------------------------------
 
     template<typename T, std::forward_iterator Iter>
     constexpr void assign_range(T* first, T* last, Iter src_first)
     noexcept(std::is_nothrow_assignable_v<T&, std::iter_reference_t<Iter>>)
     {
-        std::copy(src_first, src_first + std::distance(first, last), first);
+        std::copy_n(src_first, std::distance(first, last), first);
     }
 
     template<typename T>
@@ -299,257 +484,2052 @@ namespace detail
         std::fill(first, last, value);
     }
 
-    //------------------------------------ ALLOCATOR MANGAGED OBJECT ----------------------------------------------------
+    //---------------------------------------- SIMD ALGORITHMS ----------------------------------------------------------
 
-    template<typename T, typename Allocator>
-    class allocator_managed
+    // Branchless remove_if for trivially copyable types. This is also used for the
+    // elements that don't fill a whole vector register in the vectorized version.
+    template<typename T, typename Pred>
+    inline T* remove_if_branchless(T* first, T* last, T* out, Pred& pred)
     {
-    public:
-        template<typename... Args>
-        constexpr allocator_managed(Allocator& alloc, Args&&... args) :
-            alloc_(alloc)
-        {
-            detail::construct(alloc_, std::addressof(**this), std::forward<Args>(args)...);
-        }
-
-        constexpr ~allocator_managed() noexcept
+        for (; first != last; ++first)
         {
-            detail::destroy(alloc_, std::addressof(**this));
+            const T value = *first;
+            *out = value;
+            out += !pred(value);
         }
+        return out;
+    }
 
-        constexpr T& operator*() noexcept { return data_; }
-        constexpr const T& operator*() const noexcept { return data_; }
-
-    private:
-        union { T data_; };
-        Allocator& alloc_;
-    };
-
-    //--------------------------------------- SMALL VECTOR BUFFER -------------------------------------------------------
+#if SV_X86_SIMD
 
-    inline constexpr std::size_t cache_line_size = 64;
+    inline bool cpu_has_sse42() noexcept
+    {
+        static const bool value = __builtin_cpu_supports("sse4.2");
+        return value;
+    }
 
-    template<typename T, std::size_t Size>
-    struct small_vector_buffer
+    inline bool cpu_has_avx2() noexcept
     {
-    public:
-        constexpr small_vector_buffer() noexcept {};
-        constexpr ~small_vector_buffer() noexcept {};
+        static const bool value = __builtin_cpu_supports("avx2");
+        return value;
+    }
 
-        constexpr auto begin() noexcept { return std::begin(data_); }
-        constexpr auto begin() const noexcept { return std::begin(data_); }
+    // The lookup tables used to compact a vector register, moving the lanes selected by the mask used as the
+    // index into the table to the front of the register. One table entry contains either byte indices for pshufb,
+    // or 32 bit lane indices for vpermd.
+    template<std::size_t Lanes, std::size_t LaneBytes, std::size_t IndexBytes>
+    struct compaction_lut
+    {
+        alignas(16) std::uint8_t indices[std::size_t(1) << Lanes][Lanes * LaneBytes / IndexBytes] = {};
 
-        constexpr auto end() noexcept { return std::end(data_); }
-        constexpr auto end() const noexcept { return std::end(data_); }
+        constexpr compaction_lut() noexcept
+        {
+            constexpr std::size_t index_per_lane = LaneBytes / IndexBytes;
 
-        constexpr std::size_t size() const noexcept { return std::size(data_); }
-    private:
-        union { char dummy_ = {}; T data_[Size]; };
+            for (std::size_t mask = 0; mask < (std::size_t(1) << Lanes); mask++)
+            {
+                std::size_t out = 0;
+                for (std::size_t lane = 0; lane < Lanes; lane++)
+                {
+                    if (!(mask & (std::size_t(1) << lane))) continue;
+                    for (std::size_t i = 0; i < index_per_lane; i++)
+                    {
+                        indices[mask][out++] = std::uint8_t(lane * index_per_lane + i);
+                    }
+                }
+            }
+        }
     };
 
+    inline constexpr compaction_lut<4, 4, 1> sse_compaction_lut_32{};
+    inline constexpr compaction_lut<2, 8, 1> sse_compaction_lut_64{};
+    inline constexpr compaction_lut<8, 4, 4> avx2_compaction_lut_32{};
+    inline constexpr compaction_lut<4, 8, 4> avx2_compaction_lut_64{};
 
-    template<typename T>
-    struct default_small_size
+    // Evaluate the predicate for Lanes elements, and return a mask of the elements that should be kept.
+    template<std::size_t Lanes, typename T, typename Pred>
+    inline unsigned keep_mask(const T* first, Pred& pred)
     {
-    private:
-        inline constexpr static std::size_t overall_size = cache_line_size;
-        inline constexpr static std::size_t buffer_size = overall_size - 3 * sizeof(T*);
-        inline constexpr static std::size_t buffer_min_count = 4;
-    public:
-        inline constexpr static std::size_t value = std::max(buffer_min_count, buffer_size / sizeof(T));
-    };
+        unsigned mask = 0;
+        for (std::size_t i = 0; i < Lanes; i++) mask |= unsigned(!pred(first[i])) << i;
+        return mask;
+    }
 
-    template<typename T>
-    inline constexpr std::size_t default_small_size_v = default_small_size<T>::value;
+    // The kernels write whole registers to the output, which is fine since the output never gets ahead of the input
+    // and the part of the register past the kept elements is overwritten by the next iteration or left past the new end.
+    template<typename T, typename Pred>
+    SV_TARGET("sse4.2") T* remove_if_sse42(T* first, T* last, T* out, Pred& pred)
+    {
+        constexpr std::size_t lanes = 16 / sizeof(T);
+        const std::uint8_t* lut = (sizeof(T) == 4) ? &sse_compaction_lut_32.indices[0][0] : &sse_compaction_lut_64.indices[0][0];
 
-} // namespace detail
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
+        {
+            const unsigned mask = detail::keep_mask<lanes>(first, pred);
+            const __m128i values = _mm_loadu_si128((const __m128i*)first);
+            const __m128i shuffle = _mm_load_si128((const __m128i*)(lut + 16 * mask));
+            _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(values, shuffle));
+            out += std::popcount(mask);
+        }
+        return detail::remove_if_branchless(first, last, out, pred);
+    }
 
+    template<typename T, typename Pred>
+    SV_TARGET("avx2") T* remove_if_avx2(T* first, T* last, T* out, Pred& pred)
+    {
+        constexpr std::size_t lanes = 32 / sizeof(T);
+        const std::uint8_t* lut = (sizeof(T) == 4) ? &avx2_compaction_lut_32.indices[0][0] : &avx2_compaction_lut_64.indices[0][0];
 
-template<typename T, std::size_t Size = detail::default_small_size_v<T>, typename A = std::allocator<T>>
-class small_vector
-{
-public:
-    using value_type      = T;
-    using allocator_type  = A;
-    using reference       = T&;
-    using const_reference = const T&;
-    using pointer         = typename std::allocator_traits<A>::pointer;
-    using const_pointer   = typename std::allocator_traits<A>::const_pointer;
-    using size_type       = std::size_t;
-    using difference_type = std::ptrdiff_t;
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
+        {
+            const unsigned mask = detail::keep_mask<lanes>(first, pred);
+            const __m256i values = _mm256_loadu_si256((const __m256i*)first);
+            const __m256i permutation = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(lut + 8 * mask)));
+            _mm256_storeu_si256((__m256i*)out, _mm256_permutevar8x32_epi32(values, permutation));
+            out += std::popcount(mask);
+        }
+        return detail::remove_if_branchless(first, last, out, pred);
+    }
 
-    using iterator               = T*;
-    using const_iterator         = const T*;
-    using reverse_iterator       = std::reverse_iterator<iterator>;
-    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+#endif // SV_X86_SIMD
 
-    static_assert(Size, "The size of the inline buffer must be at least 1.");
+    // Same as std::remove_if, but uses a vectorized stream compaction kernel for arithmetic types if possible.
+    template<typename T, typename Pred>
+    constexpr T* remove_if(T* first, T* last, Pred& pred)
+    {
+        if constexpr (std::is_arithmetic_v<T>)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                T* out = std::find_if(first, last, std::ref(pred));
+                if (out == last) return last;
+
+            #if SV_X86_SIMD
+                if constexpr (sizeof(T) == 4 || sizeof(T) == 8)
+                {
+                    if (detail::cpu_has_avx2()) return detail::remove_if_avx2(out + 1, last, out, pred);
+                    if (detail::cpu_has_sse42()) return detail::remove_if_sse42(out + 1, last, out, pred);
+                }
+            #endif
+                return detail::remove_if_branchless(out + 1, last, out, pred);
+            }
+        }
 
-    //-----------------------------------//
-    //            CONSTRUCTORS           //
-    //-----------------------------------//
+        return std::remove_if(first, last, std::ref(pred));
+    }
 
-    constexpr small_vector() noexcept(std::is_nothrow_default_constructible_v<A>) :
-        first_(buffer_.begin()),
-        last_(buffer_.begin()),
-        last_alloc_(buffer_.end())
-    {}
+    // The element types for which find and count use the vectorized kernels. Integral types are compared bitwise,
+    // floating point types are compared using the vector floating point comparisons, which match operator==.
+    template<typename T>
+    inline constexpr bool is_simd_comparable_v =
+        (std::is_integral_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+        std::is_same_v<T, float> || std::is_same_v<T, double>;
 
-    constexpr explicit small_vector(const A& allocator) noexcept(std::is_nothrow_copy_constructible_v<A>) :
-        first_(buffer_.begin()),
-        last_(buffer_.begin()),
-        last_alloc_(buffer_.end()),
-        alloc_(allocator)
-    {}
+    // The max size of an inline buffer that is searched using a fixed number of vector comparisons.
+    inline constexpr std::size_t max_fixed_size_find = 64;
 
-    constexpr explicit small_vector(size_type count, const A& allocator = A()) :
-        alloc_(allocator)
-    {
-        allocate_n(count);
-        detail::scope_exit guard{ [&] { deallocate(); } };
-        detail::construct_range(alloc_, first_, first_ + count);
-        last_ = first_ + count;
-        guard.release();
-    }
+#if SV_X86_SIMD
 
-    constexpr small_vector(size_type count, const T& value, const A& allocator = A()) :
-        alloc_(allocator)
+    inline bool cpu_has_avx512bw() noexcept
     {
-        allocate_n(count);
-        detail::scope_exit guard{ [&] { deallocate(); } };
-        detail::construct_range(alloc_, first_, first_ + count, value);
-        last_ = first_ + count;
-        guard.release();
+        static const bool value = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        return value;
     }
 
-    template<std::forward_iterator Iter>
-    constexpr small_vector(Iter src_first, Iter src_last, const A& allocator = A()) :
-        alloc_(allocator)
-    {
-        const auto src_len = std::distance(src_first, src_last);
-        allocate_n(src_len);
-        detail::scope_exit guard{ [&] { deallocate(); } };
-        detail::construct_range(alloc_, first_, first_ + src_len, src_first);
-        last_ = first_ + src_len;
-        guard.release();
-    }
+    // Compare the elements in a vector register with value. The SSE2 and AVX2 versions return
+    // a mask with sizeof(T) bits set for each equal element, the AVX-512 version returns a mask
+    // with a single bit set for each equal element, and only loads the elements in load_mask.
 
-    template<std::input_iterator Iter>
-    constexpr small_vector(Iter src_first, Iter src_last, const A& allocator = A()) :
-        first_(buffer_.begin()),
-        last_(buffer_.begin()),
-        last_alloc_(buffer_.end()),
-        alloc_(allocator)
+    template<typename T>
+    inline unsigned match_mask_sse2(const T* p, T value) noexcept
     {
-        while (src_first != src_last) emplace_back(*src_first++);
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+        __m128i equal;
+
+        if constexpr (std::is_same_v<T, float>) equal = _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(chunk), _mm_set1_ps(value)));
+        else if constexpr (std::is_same_v<T, double>) equal = _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(chunk), _mm_set1_pd(value)));
+        else if constexpr (sizeof(T) == 1) equal = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(char(value)));
+        else if constexpr (sizeof(T) == 2) equal = _mm_cmpeq_epi16(chunk, _mm_set1_epi16(short(value)));
+        else if constexpr (sizeof(T) == 4) equal = _mm_cmpeq_epi32(chunk, _mm_set1_epi32(int(value)));
+        else
+        {
+            // SSE2 has no 64 bit comparison, so compare the 32 bit halves and combine the results
+            const __m128i equal_halves = _mm_cmpeq_epi32(chunk, _mm_set1_epi64x((long long)value));
+            equal = _mm_and_si128(equal_halves, _mm_shuffle_epi32(equal_halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+        return unsigned(_mm_movemask_epi8(equal));
     }
 
-    constexpr small_vector(std::initializer_list<T> init, const A& allocator = A()) :
-        small_vector(init.begin(), init.end(), allocator)
-    {}
+    template<typename T>
+    SV_TARGET("avx2") unsigned match_mask_avx2(const T* p, T value) noexcept
+    {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+        __m256i equal;
 
-    constexpr small_vector(const small_vector& other) :
-        small_vector(other.begin(), other.end(), std::allocator_traits<A>::select_on_container_copy_construction(other.alloc_))
-    {}
+        if constexpr (std::is_same_v<T, float>) equal = _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(chunk), _mm256_set1_ps(value), _CMP_EQ_OQ));
+        else if constexpr (std::is_same_v<T, double>) equal = _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(chunk), _mm256_set1_pd(value), _CMP_EQ_OQ));
+        else if constexpr (sizeof(T) == 1) equal = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(char(value)));
+        else if constexpr (sizeof(T) == 2) equal = _mm256_cmpeq_epi16(chunk, _mm256_set1_epi16(short(value)));
+        else if constexpr (sizeof(T) == 4) equal = _mm256_cmpeq_epi32(chunk, _mm256_set1_epi32(int(value)));
+        else equal = _mm256_cmpeq_epi64(chunk, _mm256_set1_epi64x((long long)value));
 
-    constexpr small_vector(const small_vector& other, const A& allocator) :
-        small_vector(other.begin(), other.end(), allocator)
-    {}
+        return unsigned(_mm256_movemask_epi8(equal));
+    }
 
-    constexpr small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T> && detail::has_trivial_construct_v<A&, T, T&&>) :
-        alloc_(std::move(other.alloc_))
+    template<typename T>
+    SV_TARGET("avx512f,avx512bw") std::uint64_t match_mask_avx512(const T* p, T value, std::uint64_t load_mask) noexcept
     {
-        if (other.is_small())
+        if constexpr (std::is_same_v<T, float>)
         {
-            set_buffer_storage(0);
-            detail::relocate_range_weak(alloc_, other.first_, other.last_, first_);
-            detail::destroy_range(alloc_, other.first_, other.last_);
-            set_buffer_storage(other.size());
-            other.last_ = other.first_;
+            const __m512 chunk = _mm512_maskz_loadu_ps(__mmask16(load_mask), p);
+            return _mm512_mask_cmp_ps_mask(__mmask16(load_mask), chunk, _mm512_set1_ps(value), _CMP_EQ_OQ);
+        }
+        else if constexpr (std::is_same_v<T, double>)
+        {
+            const __m512d chunk = _mm512_maskz_loadu_pd(__mmask8(load_mask), p);
+            return _mm512_mask_cmp_pd_mask(__mmask8(load_mask), chunk, _mm512_set1_pd(value), _CMP_EQ_OQ);
+        }
+        else if constexpr (sizeof(T) == 1)
+        {
+            const __m512i chunk = _mm512_maskz_loadu_epi8(__mmask64(load_mask), p);
+            return _mm512_mask_cmpeq_epi8_mask(__mmask64(load_mask), chunk, _mm512_set1_epi8(char(value)));
+        }
+        else if constexpr (sizeof(T) == 2)
+        {
+            const __m512i chunk = _mm512_maskz_loadu_epi16(__mmask32(load_mask), p);
+            return _mm512_mask_cmpeq_epi16_mask(__mmask32(load_mask), chunk, _mm512_set1_epi16(short(value)));
+        }
+        else if constexpr (sizeof(T) == 4)
+        {
+            const __m512i chunk = _mm512_maskz_loadu_epi32(__mmask16(load_mask), p);
+            return _mm512_mask_cmpeq_epi32_mask(__mmask16(load_mask), chunk, _mm512_set1_epi32(int(value)));
         }
         else
         {
-            first_ = std::exchange(other.first_, other.buffer_.begin());
-            last_  = std::exchange(other.last_, other.buffer_.begin());
-            last_alloc_ = std::exchange(other.last_alloc_, other.buffer_.end());
+            const __m512i chunk = _mm512_maskz_loadu_epi64(__mmask8(load_mask), p);
+            return _mm512_mask_cmpeq_epi64_mask(__mmask8(load_mask), chunk, _mm512_set1_epi64((long long)value));
         }
     }
 
-    //-----------------------------------//
-    //             DESTRUCTOR            //
-    //-----------------------------------//
+    // The SSE2 and AVX2 kernels handle the last partial register by comparing the last whole register's worth of
+    // elements again, overlapping with the previous iteration. Ranges shorter than a register use a smaller kernel.
 
-    constexpr ~small_vector() noexcept
+    template<typename T>
+    const T* find_sse2(const T* first, const T* last, T value) noexcept
     {
-        detail::destroy_range(alloc_, first_, last_);
-        deallocate();
-    }
+        constexpr std::size_t lanes = 16 / sizeof(T);
+        if (last - first < std::ptrdiff_t(lanes)) return std::find(first, last, value);
 
-    //-----------------------------------//
-    //             ASSIGNMENT            //
-    //-----------------------------------//
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
+        {
+            if (const unsigned mask = detail::match_mask_sse2(first, value)) return first + std::countr_zero(mask) / sizeof(T);
+        }
+        if (first == last) return last;
 
-    constexpr void assign(size_type count, const T& value)
+        // None of the elements before first are equal to value, so the first match is past first
+        const T* tail = last - lanes;
+        const unsigned mask = detail::match_mask_sse2(tail, value);
+        return mask ? tail + std::countr_zero(mask) / sizeof(T) : last;
+    }
+
+    template<typename T>
+    SV_TARGET("avx2") const T* find_avx2(const T* first, const T* last, T value) noexcept
     {
-        const auto src_size = difference_type(count);
-        const auto old_size = std::distance(first_, last_);
-        const auto com_size = std::min(old_size, src_size);
+        constexpr std::size_t lanes = 32 / sizeof(T);
+        if (last - first < std::ptrdiff_t(lanes)) return detail::find_sse2(first, last, value);
 
-        if (last_alloc_ - first_ >= difference_type(count))
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
         {
-            detail::assign_range(first_, first_ + com_size, value);
-            detail::construct_range(alloc_, first_ + com_size, first_ + src_size, value);
-            detail::destroy_range(alloc_, first_ + com_size, last_);
-            last_ = first_ + src_size;
+            if (const unsigned mask = detail::match_mask_avx2(first, value)) return first + std::countr_zero(mask) / sizeof(T);
         }
-        else
+        if (first == last) return last;
+
+        const T* tail = last - lanes;
+        const unsigned mask = detail::match_mask_avx2(tail, value);
+        return mask ? tail + std::countr_zero(mask) / sizeof(T) : last;
+    }
+
+    template<typename T>
+    SV_TARGET("avx512f,avx512bw") const T* find_avx512(const T* first, const T* last, T value) noexcept
+    {
+        constexpr std::size_t lanes = 64 / sizeof(T);
+
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
         {
-            size_type new_cap = next_capacity(src_size - old_size);
-            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_cap);
-            detail::scope_exit guard{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
-            detail::construct_range(alloc_, alloc_result.data, alloc_result.data + src_size, value);
-            detail::destroy_range(alloc_, first_, last_);
-            guard.release();
-            deallocate();
-            set_storage(alloc_result.data, count, alloc_result.size);
+            if (const std::uint64_t mask = detail::match_mask_avx512(first, value, ~std::uint64_t(0))) return first + std::countr_zero(mask);
         }
+        if (first == last) return last;
+
+        const std::uint64_t mask = detail::match_mask_avx512(first, value, (std::uint64_t(1) << (last - first)) - 1);
+        return mask ? first + std::countr_zero(mask) : last;
     }
 
-    template<std::forward_iterator Iter>
-    constexpr void assign(Iter src_first, Iter src_last)
+    template<typename T>
+    std::size_t count_sse2(const T* first, const T* last, T value) noexcept
     {
-        const auto src_size = std::distance(src_first, src_last);
-        const auto old_size = std::distance(first_, last_);
-        const auto com_size = std::min(old_size, src_size);
+        constexpr std::size_t lanes = 16 / sizeof(T);
+        if (last - first < std::ptrdiff_t(lanes)) return std::size_t(std::count(first, last, value));
 
-        if (last_alloc_ - first_ >= src_size)
+        std::size_t count = 0;
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
         {
-            detail::assign_range(first_, first_ + com_size, src_first);
-            detail::construct_range(alloc_, first_ + com_size, first_ + src_size, src_first + com_size);
-            detail::destroy_range(alloc_, first_ + com_size, last_);
-            last_ = first_ + src_size;
+            count += std::popcount(detail::match_mask_sse2(first, value));
         }
-        else
+        if (first != last)
         {
-            size_type new_cap = next_capacity(size_type(src_size - old_size));
-            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_cap);
-            detail::scope_exit guard{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
-            detail::construct_range(alloc_, alloc_result.data, alloc_result.data + src_size, src_first);
-            detail::destroy_range(alloc_, first_, last_);
+            // Only count the elements of the last register that weren't compared already
+            const T* tail = last - lanes;
+            count += std::popcount(detail::match_mask_sse2(tail, value) & (~0u << (sizeof(T) * std::size_t(first - tail))));
+        }
+        return count / sizeof(T);
+    }
+
+    template<typename T>
+    SV_TARGET("avx2") std::size_t count_avx2(const T* first, const T* last, T value) noexcept
+    {
+        constexpr std::size_t lanes = 32 / sizeof(T);
+        if (last - first < std::ptrdiff_t(lanes)) return detail::count_sse2(first, last, value);
+
+        std::size_t count = 0;
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
+        {
+            count += std::popcount(detail::match_mask_avx2(first, value));
+        }
+        if (first != last)
+        {
+            const T* tail = last - lanes;
+            count += std::popcount(detail::match_mask_avx2(tail, value) & (~0u << (sizeof(T) * std::size_t(first - tail))));
+        }
+        return count / sizeof(T);
+    }
+
+    template<typename T>
+    SV_TARGET("avx512f,avx512bw") std::size_t count_avx512(const T* first, const T* last, T value) noexcept
+    {
+        constexpr std::size_t lanes = 64 / sizeof(T);
+
+        std::size_t count = 0;
+        for (; last - first >= std::ptrdiff_t(lanes); first += lanes)
+        {
+            count += std::popcount(detail::match_mask_avx512(first, value, ~std::uint64_t(0)));
+        }
+        if (first != last)
+        {
+            count += std::popcount(detail::match_mask_avx512(first, value, (std::uint64_t(1) << (last - first)) - 1));
+        }
+        return count;
+    }
+
+    // Compare the first N elements at p with value using a fixed number of SSE2 comparisons, without reading past
+    // the N elements. If the elements don't fill a whole number of registers, the last register overlaps with the
+    // previous one, and buffers smaller than a register are copied into a register sized buffer first.
+    // The result has sizeof(T) bits set for each equal element, like the result of match_mask_sse2.
+    template<std::size_t N, typename T>
+    inline std::uint64_t match_mask_fixed(const T* p, T value) noexcept
+    {
+        constexpr std::size_t bytes = N * sizeof(T);
+        static_assert(bytes <= 64);
+
+        if constexpr (bytes < 16)
+        {
+            alignas(16) unsigned char padded[16] = {};
+            std::memcpy(padded, p, bytes);
+            return detail::match_mask_sse2((const T*)padded, value);
+        }
+        else
+        {
+            constexpr std::size_t lanes = 16 / sizeof(T);
+            const auto whole_chunks = [&]<std::size_t... I>(std::index_sequence<I...>)
+            {
+                return ((std::uint64_t(detail::match_mask_sse2(p + I * lanes, value)) << (16 * I)) | ... | 0);
+            };
+
+            std::uint64_t mask = whole_chunks(std::make_index_sequence<bytes / 16>{});
+            if constexpr (bytes % 16)
+            {
+                mask |= std::uint64_t(detail::match_mask_sse2(p + N - lanes, value)) << (bytes - 16);
+            }
+            return mask;
+        }
+    }
+
+    // The mask of the elements of a vector of the given size in the result of match_mask_fixed.
+    template<typename T>
+    inline std::uint64_t fixed_size_mask(std::size_t size) noexcept
+    {
+        const std::size_t bits = size * sizeof(T);
+        return (bits >= 64) ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+    }
+
+#endif // SV_X86_SIMD
+
+    // Same as std::find, but uses a vectorized kernel for arithmetic types if possible.
+    template<typename T>
+    constexpr const T* find(const T* first, const T* last, const T& value)
+    {
+        if constexpr (detail::is_simd_comparable_v<T>)
+        {
+        #if SV_X86_SIMD
+            if (!std::is_constant_evaluated())
+            {
+                if (detail::cpu_has_avx512bw()) return detail::find_avx512(first, last, value);
+                if (detail::cpu_has_avx2()) return detail::find_avx2(first, last, value);
+                return detail::find_sse2(first, last, value);
+            }
+        #endif
+        }
+        return std::find(first, last, value);
+    }
+
+    // Same as std::count, but uses a vectorized kernel for arithmetic types if possible.
+    template<typename T>
+    constexpr std::size_t count(const T* first, const T* last, const T& value)
+    {
+        if constexpr (detail::is_simd_comparable_v<T>)
+        {
+        #if SV_X86_SIMD
+            if (!std::is_constant_evaluated())
+            {
+                if (detail::cpu_has_avx512bw()) return detail::count_avx512(first, last, value);
+                if (detail::cpu_has_avx2()) return detail::count_avx2(first, last, value);
+                return detail::count_sse2(first, last, value);
+            }
+        #endif
+        }
+        return std::size_t(std::count(first, last, value));
+    }
+
+    // Find the first element equal to value in an inline buffer of N elements, of which the first size elements are
+    // used. The whole buffer is compared with a fixed trip count, and the unused elements are masked out afterwards.
+    template<std::size_t N, typename T>
+    constexpr std::size_t find_fixed(const T* buffer, std::size_t size, const T& value)
+    {
+    #if SV_X86_SIMD
+        if (!std::is_constant_evaluated())
+        {
+            const std::uint64_t mask = detail::match_mask_fixed<N>(buffer, value) & detail::fixed_size_mask<T>(size);
+            return mask ? std::size_t(std::countr_zero(mask)) / sizeof(T) : size;
+        }
+    #endif
+        return std::size_t(std::find(buffer, buffer + size, value) - buffer);
+    }
+
+    template<std::size_t N, typename T>
+    constexpr std::size_t count_fixed(const T* buffer, std::size_t size, const T& value)
+    {
+    #if SV_X86_SIMD
+        if (!std::is_constant_evaluated())
+        {
+            const std::uint64_t mask = detail::match_mask_fixed<N>(buffer, value) & detail::fixed_size_mask<T>(size);
+            return std::size_t(std::popcount(mask)) / sizeof(T);
+        }
+    #endif
+        return std::size_t(std::count(buffer, buffer + size, value));
+    }
+
+    // The element types for which operator== compares the object representations of the elements with memcmp.
+    // This is only done for scalar types, since class types could define operator== in a different way.
+    template<typename T>
+    inline constexpr bool is_memcmp_equality_comparable_v = std::is_scalar_v<T> && std::has_unique_object_representations_v<T>;
+
+    // The element types for which the lexicographical ordering of the elements is the same as the ordering of
+    // their object representations compared with memcmp, that is, unsigned integers in big-endian byte order.
+    template<typename T>
+    inline constexpr bool is_memcmp_orderable_v = std::is_same_v<T, std::byte> ||
+        (std::is_integral_v<T> && std::is_unsigned_v<T> && (sizeof(T) == 1 || std::endian::native == std::endian::big));
+
+#if SV_X86_SIMD
+
+    // Return the byte offset of the first byte that differs in the two buffers, or size if they are equal.
+    inline std::size_t mismatch_sse2(const unsigned char* lhs, const unsigned char* rhs, std::size_t size) noexcept
+    {
+        if (size < 16) return std::size_t(std::mismatch(lhs, lhs + size, rhs).first - lhs);
+
+        std::size_t offset = 0;
+        for (; size - offset >= 16; offset += 16)
+        {
+            const __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(lhs + offset)), _mm_loadu_si128((const __m128i*)(rhs + offset)));
+            if (const unsigned mask = ~unsigned(_mm_movemask_epi8(equal)) & 0xFFFF) return offset + std::countr_zero(mask);
+        }
+        if (offset == size) return size;
+
+        // The bytes before offset are known to be equal, so the first mismatch is past offset
+        offset = size - 16;
+        const __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(lhs + offset)), _mm_loadu_si128((const __m128i*)(rhs + offset)));
+        const unsigned mask = ~unsigned(_mm_movemask_epi8(equal)) & 0xFFFF;
+        return mask ? offset + std::countr_zero(mask) : size;
+    }
+
+    SV_TARGET("avx2") inline std::size_t mismatch_avx2(const unsigned char* lhs, const unsigned char* rhs, std::size_t size) noexcept
+    {
+        if (size < 32) return detail::mismatch_sse2(lhs, rhs, size);
+
+        std::size_t offset = 0;
+        for (; size - offset >= 32; offset += 32)
+        {
+            const __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(lhs + offset)), _mm256_loadu_si256((const __m256i*)(rhs + offset)));
+            if (const unsigned mask = ~unsigned(_mm256_movemask_epi8(equal))) return offset + std::countr_zero(mask);
+        }
+        if (offset == size) return size;
+
+        offset = size - 32;
+        const __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(lhs + offset)), _mm256_loadu_si256((const __m256i*)(rhs + offset)));
+        const unsigned mask = ~unsigned(_mm256_movemask_epi8(equal));
+        return mask ? offset + std::countr_zero(mask) : size;
+    }
+
+#endif // SV_X86_SIMD
+
+    // Return the index of the first element that differs in the two ranges of size elements, or size if they are equal.
+    // Elements of integral types are compared bitwise using a vectorized kernel if possible.
+    template<typename T>
+    constexpr std::size_t mismatch(const T* lhs, const T* rhs, std::size_t size)
+    {
+        if constexpr (std::is_integral_v<T>)
+        {
+        #if SV_X86_SIMD
+            if (!std::is_constant_evaluated())
+            {
+                // Ranges that differ in their first element are common (e.g. when sorting), so check it before dispatching
+                if (size == 0 || *lhs != *rhs) return 0;
+
+                const auto lhs_bytes = reinterpret_cast<const unsigned char*>(lhs);
+                const auto rhs_bytes = reinterpret_cast<const unsigned char*>(rhs);
+
+                const std::size_t offset = detail::cpu_has_avx2() ?
+                    detail::mismatch_avx2(lhs_bytes, rhs_bytes, size * sizeof(T)) :
+                    detail::mismatch_sse2(lhs_bytes, rhs_bytes, size * sizeof(T));
+
+                return offset / sizeof(T);
+            }
+        #endif
+        }
+        return std::size_t(std::mismatch(lhs, lhs + size, rhs).first - lhs);
+    }
+
+    //--------------------------------------------- HASHING -------------------------------------------------------------
+
+    // The hash function used for the contents of vectors of trivial types is wyhash (final version 4), by Wang Yi,
+    // released into the public domain. See https://github.com/wangyi-fudan/wyhash
+
+    inline constexpr std::uint64_t wyhash_secret[4] = { 0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47 };
+
+    // Multiply a and b, and return the low and high 64 bits of the 128 bit product in a and b.
+    inline void multiply_128(std::uint64_t& a, std::uint64_t& b) noexcept
+    {
+    #if defined(__SIZEOF_INT128__)
+        __extension__ using uint128_t = unsigned __int128;
+        const uint128_t product = uint128_t(a) * b;
+        a = std::uint64_t(product);
+        b = std::uint64_t(product >> 64);
+    #else
+        const std::uint64_t a_hi = a >> 32, a_lo = std::uint32_t(a);
+        const std::uint64_t b_hi = b >> 32, b_lo = std::uint32_t(b);
+
+        const std::uint64_t hh = a_hi * b_hi, hl = a_hi * b_lo, lh = a_lo * b_hi, ll = a_lo * b_lo;
+        const std::uint64_t mid = (ll >> 32) + std::uint32_t(hl) + std::uint32_t(lh);
+
+        a = (mid << 32) | std::uint32_t(ll);
+        b = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+    #endif
+    }
+
+    inline std::uint64_t wyhash_mix(std::uint64_t a, std::uint64_t b) noexcept
+    {
+        detail::multiply_128(a, b);
+        return a ^ b;
+    }
+
+    inline std::uint64_t wyhash_read8(const unsigned char* p) noexcept { std::uint64_t value; std::memcpy(&value, p, 8); return value; }
+    inline std::uint64_t wyhash_read4(const unsigned char* p) noexcept { std::uint32_t value; std::memcpy(&value, p, 4); return value; }
+    inline std::uint64_t wyhash_read3(const unsigned char* p, std::size_t k) noexcept
+    {
+        return (std::uint64_t(p[0]) << 16) | (std::uint64_t(p[k >> 1]) << 8) | p[k - 1];
+    }
+
+    inline std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t seed = 0) noexcept
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        const std::uint64_t* secret = wyhash_secret;
+
+        seed ^= detail::wyhash_mix(seed ^ secret[0], secret[1]);
+
+        std::uint64_t a, b;
+        if (size <= 16)
+        {
+            if (size >= 4)
+            {
+                a = (detail::wyhash_read4(p) << 32) | detail::wyhash_read4(p + ((size >> 3) << 2));
+                b = (detail::wyhash_read4(p + size - 4) << 32) | detail::wyhash_read4(p + size - 4 - ((size >> 3) << 2));
+            }
+            else if (size > 0)
+            {
+                a = detail::wyhash_read3(p, size);
+                b = 0;
+            }
+            else
+            {
+                a = b = 0;
+            }
+        }
+        else
+        {
+            std::size_t i = size;
+            if (i > 48)
+            {
+                std::uint64_t see1 = seed, see2 = seed;
+                do
+                {
+                    seed = detail::wyhash_mix(detail::wyhash_read8(p) ^ secret[1], detail::wyhash_read8(p + 8) ^ seed);
+                    see1 = detail::wyhash_mix(detail::wyhash_read8(p + 16) ^ secret[2], detail::wyhash_read8(p + 24) ^ see1);
+                    see2 = detail::wyhash_mix(detail::wyhash_read8(p + 32) ^ secret[3], detail::wyhash_read8(p + 40) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16)
+            {
+                seed = detail::wyhash_mix(detail::wyhash_read8(p) ^ secret[1], detail::wyhash_read8(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = detail::wyhash_read8(p + i - 16);
+            b = detail::wyhash_read8(p + i - 8);
+        }
+
+        a ^= secret[1];
+        b ^= seed;
+        detail::multiply_128(a, b);
+
+        return detail::wyhash_mix(a ^ secret[0] ^ size, b ^ secret[1]);
+    }
+
+    // The element types for which the hash of a vector is computed from the object representations of the elements.
+    // This is the same condition as the one used by operator== to compare the object representations.
+    template<typename T>
+    inline constexpr bool is_bytewise_hashable_v = is_memcmp_equality_comparable_v<T>;
+
+    template<typename T>
+    concept std_hashable = requires(const T& value) { { std::hash<T>{}(value) } -> std::convertible_to<std::size_t>; };
+
+    // Hash a range of elements. The result only depends on the values of the elements.
+    template<typename T>
+    std::size_t hash_range(const T* first, const T* last) noexcept(is_bytewise_hashable_v<T> || noexcept(std::hash<T>{}(*first)))
+    {
+        if constexpr (is_bytewise_hashable_v<T>)
+        {
+            return std::size_t(detail::hash_bytes(first, std::size_t(last - first) * sizeof(T)));
+        }
+        else
+        {
+            std::uint64_t seed = wyhash_secret[0] ^ std::uint64_t(last - first);
+            for (; first != last; ++first)
+            {
+                seed = detail::wyhash_mix(seed ^ std::uint64_t(std::hash<T>{}(*first)), wyhash_secret[1]);
+            }
+            return std::size_t(detail::wyhash_mix(seed, wyhash_secret[2]));
+        }
+    }
+
+    //------------------------------------ ALLOCATOR MANGAGED OBJECT ----------------------------------------------------
+
+    template<typename T, typename Allocator>
+    class allocator_managed
+    {
+    public:
+        template<typename... Args>
+        constexpr allocator_managed(Allocator& alloc, Args&&... args) :
+            alloc_(alloc)
+        {
+            detail::construct(alloc_, std::addressof(**this), std::forward<Args>(args)...);
+        }
+
+        constexpr ~allocator_managed() noexcept
+        {
+            detail::destroy(alloc_, std::addressof(**this));
+        }
+
+        constexpr T& operator*() noexcept { return data_; }
+        constexpr const T& operator*() const noexcept { return data_; }
+
+    private:
+        union { T data_; };
+        Allocator& alloc_;
+    };
+
+    //--------------------------------------- SMALL VECTOR BUFFER -------------------------------------------------------
+
+    inline constexpr std::size_t cache_line_size = 64;
+
+    // The max size of an inline buffer that is always copied as a whole, instead of only copying its used part.
+    inline constexpr std::size_t max_fixed_size_copy = 4 * cache_line_size;
+
+    // Swap the contents of two non-overlapping memory blocks of Bytes bytes.
+    // The size is a compile-time constant, so the copies can be fully unrolled and vectorized.
+    template<std::size_t Bytes>
+    void swap_bytes(void* lhs, void* rhs) noexcept
+    {
+        unsigned char temp[Bytes];
+        std::memcpy(temp, lhs, Bytes);
+        std::memcpy(lhs, rhs, Bytes);
+        std::memcpy(rhs, temp, Bytes);
+    }
+
+    // Swap the contents of two non-overlapping memory blocks of count bytes.
+    inline void swap_bytes(void* lhs, void* rhs, std::size_t count) noexcept
+    {
+        constexpr std::size_t block_size = cache_line_size;
+
+        unsigned char* left  = static_cast<unsigned char*>(lhs);
+        unsigned char* right = static_cast<unsigned char*>(rhs);
+
+        for (; count >= block_size; count -= block_size, left += block_size, right += block_size)
+        {
+            detail::swap_bytes<block_size>(left, right);
+        }
+        std::swap_ranges(left, left + count, right);
+    }
+
+    template<typename T, std::size_t Size>
+    struct small_vector_buffer
+    {
+    public:
+        constexpr small_vector_buffer() noexcept {};
+        constexpr ~small_vector_buffer() noexcept {};
+
+        constexpr auto begin() noexcept { return std::begin(data_); }
+        constexpr auto begin() const noexcept { return std::begin(data_); }
+
+        constexpr auto end() noexcept { return std::end(data_); }
+        constexpr auto end() const noexcept { return std::end(data_); }
+
+        constexpr std::size_t size() const noexcept { return std::size(data_); }
+    private:
+        union { char dummy_ = {}; T data_[Size]; };
+    };
+
+
+    // The default size of the inline buffer, chosen so that the whole small_vector object fits into ByteBudget bytes
+    // if possible. At least buffer_min_count elements are stored inline, unless they wouldn't fit into the budget.
+    template<typename T, std::size_t ByteBudget = cache_line_size>
+    struct default_small_size
+    {
+    private:
+        inline constexpr static std::size_t overall_size = ByteBudget;
+        inline constexpr static std::size_t header_size = 3 * sizeof(T*);
+        inline constexpr static std::size_t buffer_size = (overall_size > header_size) ? overall_size - header_size : 0;
+        inline constexpr static std::size_t buffer_min_count = std::min<std::size_t>(4, std::max<std::size_t>(1, overall_size / sizeof(T)));
+    public:
+        inline constexpr static std::size_t value = std::max(buffer_min_count, buffer_size / sizeof(T));
+    };
+
+    template<typename T, std::size_t ByteBudget = cache_line_size>
+    inline constexpr std::size_t default_small_size_v = default_small_size<T, ByteBudget>::value;
+
+    // The number of elements that fit into the inline buffer of Size elements if it is extended
+    // to also cover the padding between the buffer and the next member with the given alignment.
+    template<typename T, std::size_t Size>
+    constexpr std::size_t padded_buffer_capacity(std::size_t next_member_alignment) noexcept
+    {
+        const std::size_t buffer_size = Size * sizeof(T);
+        const std::size_t padded_size = (buffer_size + next_member_alignment - 1) / next_member_alignment * next_member_alignment;
+
+        return padded_size / sizeof(T);
+    }
+
+    //--------------------------------------- SMALL VECTOR STORAGE ------------------------------------------------------
+
+    // Stores the location of the elements as 3 pointers: the first element, one past the last
+    // element, and one past the end of the allocated storage.
+    template<typename Pointer>
+    class pointer_storage
+    {
+    public:
+        constexpr pointer_storage() noexcept = default;
+
+        constexpr pointer_storage(Pointer first, std::size_t size, std::size_t capacity) noexcept :
+            first_(first), last_(first + size), last_alloc_(first + capacity)
+        {}
+
+        constexpr Pointer first() const noexcept { return first_; }
+        constexpr Pointer last() const noexcept { return last_; }
+
+        constexpr std::size_t size() const noexcept { return std::size_t(last_ - first_); }
+        constexpr std::size_t capacity() const noexcept { return std::size_t(last_alloc_ - first_); }
+
+        static constexpr std::size_t max_size() noexcept { return std::numeric_limits<std::size_t>::max(); }
+
+        constexpr void set(Pointer first, std::size_t size, std::size_t capacity) noexcept
+        {
+            first_ = first;
+            last_ = first + size;
+            last_alloc_ = first + capacity;
+        }
+
+        constexpr void set_size(std::size_t size) noexcept { last_ = first_ + size; }
+        constexpr void set_last(Pointer last) noexcept { last_ = last; }
+
+    private:
+        Pointer first_      = nullptr;
+        Pointer last_       = nullptr;
+        Pointer last_alloc_ = nullptr;
+    };
+
+    // Stores the location of the elements as a pointer to the first element, and the size and
+    // capacity as integers of type SizeType, which is usually narrower than a pointer.
+    template<typename Pointer, typename SizeType>
+    class compact_storage
+    {
+    public:
+        constexpr compact_storage() noexcept = default;
+
+        constexpr compact_storage(Pointer first, std::size_t size, std::size_t capacity) noexcept
+        {
+            set(first, size, capacity);
+        }
+
+        constexpr Pointer first() const noexcept { return first_; }
+        constexpr Pointer last() const noexcept { return first_ + size_; }
+
+        constexpr std::size_t size() const noexcept { return size_; }
+        constexpr std::size_t capacity() const noexcept { return capacity_; }
+
+        static constexpr std::size_t max_size() noexcept { return std::numeric_limits<SizeType>::max(); }
+
+        constexpr void set(Pointer first, std::size_t size, std::size_t capacity) noexcept
+        {
+            first_ = first;
+            size_ = SizeType(size);
+            capacity_ = SizeType(capacity);
+        }
+
+        constexpr void set_size(std::size_t size) noexcept { size_ = SizeType(size); }
+        constexpr void set_last(Pointer last) noexcept { size_ = SizeType(last - first_); }
+
+    private:
+        Pointer first_     = nullptr;
+        SizeType size_     = 0;
+        SizeType capacity_ = 0;
+    };
+
+} // namespace detail
+
+
+//------------------------------------------- MALLOC ALLOCATOR --------------------------------------------------------
+
+// An allocator that uses malloc() and free(). It also provides a reallocate() method, which
+// allows small_vector to grow the heap storage of trivially relocatable types using realloc(),
+// avoiding the copy when the block can be extended in place. For large blocks, realloc()
+// remaps the pages of the allocation instead of copying them on most platforms (e.g. mremap() in glibc).
+template<typename T>
+struct malloc_allocator
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "The alignment of T is not supported by malloc_allocator.");
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using is_always_equal = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    constexpr malloc_allocator() noexcept = default;
+
+    template<typename U>
+    constexpr malloc_allocator(const malloc_allocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(size_type count)
+    {
+        if (count > std::numeric_limits<size_type>::max() / sizeof(T)) throw std::bad_array_new_length{};
+
+        void* data = std::malloc(count * sizeof(T));
+        if (!data && count) throw std::bad_alloc{};
+
+        return static_cast<T*>(data);
+    }
+
+    [[nodiscard]] T* reallocate(T* data, size_type, size_type new_count)
+    {
+        if (new_count > std::numeric_limits<size_type>::max() / sizeof(T)) throw std::bad_array_new_length{};
+
+        void* new_data = std::realloc(data, new_count * sizeof(T));
+        if (!new_data && new_count) throw std::bad_alloc{};
+
+        return static_cast<T*>(new_data);
+    }
+
+    void deallocate(T* data, size_type) noexcept
+    {
+        std::free(data);
+    }
+
+    template<typename U>
+    friend constexpr bool operator==(const malloc_allocator&, const malloc_allocator<U>&) noexcept { return true; }
+};
+
+//------------------------------------------- ARENA ALLOCATOR ---------------------------------------------------------
+
+// A monotonic arena that allocates by bumping a pointer through large blocks of memory. Individual
+// allocations are never freed, the memory is reclaimed all at once by rewinding the arena to an
+// earlier checkpoint or resetting it. The blocks are kept after a rewind, so an arena that is
+// reset after every request stops allocating from the system once it has grown large enough.
+class bump_arena
+{
+public:
+    // A position in the arena that it can be rewound to.
+    struct checkpoint
+    {
+        void* block;
+        std::byte* top;
+    };
+
+    // The allocations are padded to this granularity, so that the next allocation is suitably aligned for most types.
+    static constexpr std::size_t granularity = alignof(std::max_align_t);
+
+    static constexpr std::size_t default_block_size = 64 * 1024;
+
+    explicit bump_arena(std::size_t block_size = default_block_size) noexcept :
+        block_size_(std::max(block_size, sizeof(block_header)))
+    {}
+
+    bump_arena(const bump_arena&)            = delete;
+    bump_arena& operator=(const bump_arena&) = delete;
+
+    ~bump_arena() noexcept { release(); }
+
+    // Allocate at least 'bytes' bytes of memory aligned to 'alignment'. The actual size of the allocation
+    // is written to 'allocated_bytes', which includes the padding up to the next multiple of the granularity.
+    [[nodiscard]] void* allocate(std::size_t bytes, std::size_t alignment, std::size_t& allocated_bytes)
+    {
+        allocated_bytes = round_up(bytes, granularity);
+        if (allocated_bytes < bytes) throw std::bad_array_new_length{};
+
+        const std::size_t padding = (0 - reinterpret_cast<std::uintptr_t>(top_)) & (alignment - 1);
+
+        if (allocated_bytes + padding > std::size_t(end_ - top_)) [[unlikely]] return allocate_slow(allocated_bytes, alignment);
+
+        std::byte* data = top_ + padding;
+        top_ = data + allocated_bytes;
+
+        return data;
+    }
+
+    [[nodiscard]] void* allocate(std::size_t bytes, std::size_t alignment)
+    {
+        std::size_t allocated_bytes;
+        return allocate(bytes, alignment, allocated_bytes);
+    }
+
+    // Try to change the size of the allocation at 'data' in place, which is only possible for the last allocation.
+    [[nodiscard]] bool try_resize(void* data, std::size_t old_bytes, std::size_t new_bytes) noexcept
+    {
+        std::byte* first = static_cast<std::byte*>(data);
+
+        if (!first || round_up(old_bytes, granularity) != std::size_t(top_ - first)) return false;
+        if (new_bytes > std::size_t(end_ - first) || round_up(new_bytes, granularity) > std::size_t(end_ - first)) return false; // overflow safe
+
+        top_ = first + round_up(new_bytes, granularity);
+
+        return true;
+    }
+
+    checkpoint mark() const noexcept { return { current_, top_ }; }
+
+    // Release every allocation made after the checkpoint was taken. The memory blocks of the arena are kept for reuse.
+    void rewind(checkpoint point) noexcept
+    {
+        current_ = static_cast<block_header*>(point.block);
+        top_ = point.top;
+        end_ = current_ ? block_end(current_) : nullptr;
+    }
+
+    // Release every allocation, but keep the memory blocks of the arena for reuse.
+    void reset() noexcept { rewind({ nullptr, nullptr }); }
+
+    // Release every allocation, and return the memory blocks of the arena to the system.
+    void release() noexcept
+    {
+        while (first_)
+        {
+            block_header* next = first_->next;
+            ::operator delete(static_cast<void*>(first_));
+            first_ = next;
+        }
+        reserved_ = 0;
+        reset();
+    }
+
+    // The total size of the memory blocks owned by the arena.
+    std::size_t reserved() const noexcept { return reserved_; }
+
+    // The arena used by the default constructed arena_allocators of the calling thread.
+    static bump_arena& thread_local_arena() noexcept
+    {
+        thread_local bump_arena arena;
+        return arena;
+    }
+
+private:
+    struct alignas(std::max_align_t) block_header
+    {
+        block_header* next;
+        std::size_t size;
+    };
+
+    block_header* first_   = nullptr;
+    block_header* current_ = nullptr;
+    std::byte* top_        = nullptr;
+    std::byte* end_        = nullptr;
+    std::size_t block_size_;
+    std::size_t reserved_  = 0;
+
+    static constexpr std::size_t round_up(std::size_t n, std::size_t alignment) noexcept
+    {
+        return (n + alignment - 1) & ~(alignment - 1);
+    }
+
+    static std::byte* block_begin(block_header* block) noexcept { return reinterpret_cast<std::byte*>(block + 1); }
+    static std::byte* block_end(block_header* block) noexcept { return reinterpret_cast<std::byte*>(block) + block->size; }
+
+    // Move to the next memory block that is large enough for the allocation, reusing the blocks kept after a rewind if possible.
+    void* allocate_slow(std::size_t bytes, std::size_t alignment)
+    {
+        const std::size_t required_size = sizeof(block_header) + bytes + (alignment > granularity ? alignment : 0);
+        if (required_size < bytes) throw std::bad_array_new_length{};
+
+        block_header* next = current_ ? current_->next : first_;
+
+        if (!next || next->size < required_size)
+        {
+            const std::size_t block_size = std::max(block_size_, required_size);
+            block_header* block = static_cast<block_header*>(::operator new(block_size));
+
+            block->next = next;
+            block->size = block_size;
+            (current_ ? current_->next : first_) = block;
+            reserved_ += block_size;
+            next = block;
+        }
+
+        current_ = next;
+        top_ = block_begin(current_);
+        end_ = block_end(current_);
+
+        std::size_t allocated_bytes;
+        return allocate(bytes, alignment, allocated_bytes);
+    }
+};
+
+// Rewinds an arena to the point where the scope was entered when the scope is exited,
+// releasing all of the allocations made from the arena in the meantime.
+class [[nodiscard]] arena_scope
+{
+public:
+    explicit arena_scope(bump_arena& arena = bump_arena::thread_local_arena()) noexcept :
+        arena_(arena), checkpoint_(arena.mark())
+    {}
+
+    arena_scope(const arena_scope&)            = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+
+    ~arena_scope() noexcept { arena_.rewind(checkpoint_); }
+
+private:
+    bump_arena& arena_;
+    bump_arena::checkpoint checkpoint_;
+};
+
+// An allocator that allocates from a bump_arena, using the arena of the current thread by default.
+// Deallocation is a no-op, which small_vector takes advantage of by not shrinking heap allocations.
+// The padding of the allocations is returned to the containers by allocate_at_least(), and the
+// reallocate() method grows the last allocation of the arena in place.
+template<typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using trivial_deallocate = std::true_type;
+
+#if __cpp_lib_allocate_at_least
+    using allocation_result = std::allocation_result<T*, size_type>;
+#else
+    struct allocation_result { T* ptr; size_type count; };
+#endif
+
+    arena_allocator() noexcept : arena_(&bump_arena::thread_local_arena()) {}
+
+    explicit arena_allocator(bump_arena& arena) noexcept : arena_(&arena) {}
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    [[nodiscard]] T* allocate(size_type count)
+    {
+        return allocate_at_least(count).ptr;
+    }
+
+    [[nodiscard]] allocation_result allocate_at_least(size_type count)
+    {
+        if (count > std::numeric_limits<size_type>::max() / sizeof(T)) throw std::bad_array_new_length{};
+
+        std::size_t allocated_bytes;
+        void* data = arena_->allocate(count * sizeof(T), alignof(T), allocated_bytes);
+
+        return { static_cast<T*>(data), allocated_bytes / sizeof(T) };
+    }
+
+    [[nodiscard]] T* reallocate(T* data, size_type old_count, size_type new_count)
+    {
+        if (new_count > std::numeric_limits<size_type>::max() / sizeof(T)) throw std::bad_array_new_length{};
+
+        if (arena_->try_resize(data, old_count * sizeof(T), new_count * sizeof(T))) return data;
+
+        T* new_data = static_cast<T*>(arena_->allocate(new_count * sizeof(T), alignof(T)));
+        if (data) std::memcpy(static_cast<void*>(new_data), static_cast<const void*>(data), std::min(old_count, new_count) * sizeof(T));
+
+        return new_data;
+    }
+
+    void deallocate(T*, size_type) noexcept {}
+
+    bump_arena* arena() const noexcept { return arena_; }
+
+    template<typename U>
+    friend bool operator==(const arena_allocator& lhs, const arena_allocator<U>& rhs) noexcept { return lhs.arena() == rhs.arena(); }
+
+private:
+    bump_arena* arena_;
+};
+
+//------------------------------------------- LAYOUT POLICIES ---------------------------------------------------------
+
+// The default layout of small_vector, the elements are tracked using 3 pointers.
+struct pointer_layout
+{
+    template<typename Pointer>
+    using storage_type = detail::pointer_storage<Pointer>;
+};
+
+// A more compact layout that tracks the elements using a single pointer, and stores the size and
+// capacity of the vector as SizeType. The size of a vector using this layout can't exceed the maximum value of SizeType.
+template<std::unsigned_integral SizeType = std::uint32_t>
+struct compact_layout
+{
+    template<typename Pointer>
+    using storage_type = detail::compact_storage<Pointer, SizeType>;
+};
+
+//----------------------------------------- ALIGNMENT POLICIES --------------------------------------------------------
+
+// The inline buffer is aligned as required by the element type, similar to a regular array of the elements.
+struct natural_alignment
+{
+    static constexpr std::size_t min_alignment = 1;
+    static constexpr bool fill_padding = false;
+};
+
+// The inline buffer is aligned to a cache line boundary, so the inline elements are never split across cache lines,
+// at the cost of the size of the vector always being a multiple of the cache line size.
+struct cache_line_alignment
+{
+    static constexpr std::size_t min_alignment = detail::cache_line_size;
+    static constexpr bool fill_padding = false;
+};
+
+// Same as natural_alignment, but the inline buffer is extended to use the padding bytes that would otherwise
+// be wasted after it. The inline capacity may be larger than the Size template parameter.
+struct packed_alignment
+{
+    static constexpr std::size_t min_alignment = 1;
+    static constexpr bool fill_padding = true;
+};
+
+//------------------------------------------ GROWTH POLICIES ---------------------------------------------------------
+
+// The parameters passed to the growth policy of a small_vector when it has to reallocate.
+// The capacity returned by the policy is clamped to the range [min_capacity, max_capacity].
+struct growth_params
+{
+    std::size_t capacity;       // The current capacity of the vector.
+    std::size_t min_capacity;   // The minimum capacity required after the reallocation.
+    std::size_t max_capacity;   // The max_size() of the vector.
+    std::size_t element_size;   // The size of the elements in bytes.
+    bool is_small;              // The vector is currently using its inline buffer.
+};
+
+// The capacity of the vector is multiplied by Num / Den every time it has to grow.
+template<std::size_t Num, std::size_t Den>
+struct geometric_growth
+{
+    static_assert(Den != 0 && Num > Den, "The growth factor must be greater than 1.");
+
+    static constexpr std::size_t next_capacity(const growth_params& params) noexcept
+    {
+        const std::size_t capacity = params.capacity;
+        const std::size_t growth = capacity / Den * (Num - Den) + capacity % Den * (Num - Den) / Den;
+
+        if (capacity > params.max_capacity - growth) return params.max_capacity;
+
+        return std::max(params.min_capacity, capacity + growth);
+    }
+};
+
+using growth_factor_1_5 = geometric_growth<3, 2>;
+using growth_factor_2   = geometric_growth<2, 1>;
+
+// The allocated storage is always a power of 2 bytes, which matches the size classes of most allocators.
+struct power_of_two_growth
+{
+    static constexpr std::size_t next_capacity(const growth_params& params) noexcept
+    {
+        constexpr std::size_t max_pow2 = std::size_t(1) << (std::numeric_limits<std::size_t>::digits - 1);
+
+        if (params.min_capacity > max_pow2 / params.element_size) return params.max_capacity;
+
+        return std::bit_ceil(params.min_capacity * params.element_size) / params.element_size;
+    }
+};
+
+// The vector only allocates as much storage as it needs to, this minimizes the memory usage of the vector,
+// but the amortized cost of push_back is no longer constant.
+struct exact_growth
+{
+    static constexpr std::size_t next_capacity(const growth_params& params) noexcept
+    {
+        return params.min_capacity;
+    }
+};
+
+// Allocates at least FirstCapacity elements when the vector first moves from the inline buffer to the heap,
+// and uses the Growth policy after that.
+template<std::size_t FirstCapacity, typename Growth = growth_factor_1_5>
+struct first_spill_growth
+{
+    static constexpr std::size_t next_capacity(const growth_params& params) noexcept
+    {
+        if (params.is_small) return std::max(FirstCapacity, params.min_capacity);
+
+        return Growth::next_capacity(params);
+    }
+};
+
+//------------------------------------------ SHRINK POLICIES ---------------------------------------------------------
+
+// The parameters passed to the shrink policy of a small_vector after elements are removed from it.
+struct shrink_params
+{
+    std::size_t size;               // The size of the vector after the elements were removed.
+    std::size_t capacity;           // The current capacity of the vector.
+    std::size_t inline_capacity;    // The capacity of the inline buffer of the vector.
+    std::size_t element_size;       // The size of the elements in bytes.
+};
+
+// The capacity of the vector is never reduced automatically, only by an explicit call to shrink_to_fit().
+struct no_shrink
+{
+    static constexpr std::size_t shrink_capacity(const shrink_params& params) noexcept
+    {
+        return params.capacity;
+    }
+};
+
+// The heap storage of the vector is shrunk to twice its size once the size of the vector drops below
+// Num / Den of its capacity. The elements are moved back to the inline buffer if they fit in it.
+// The gap between the two thresholds avoids reallocating repeatedly when the size oscillates around a threshold.
+// Unlike with std::vector, pop_back(), erase(), erase_unordered(), erase_if() and resize() may reallocate the vector
+// with this policy, which invalidates all of its iterators and references, not just the ones after the removed elements.
+// The iterators returned by erase() and erase_unordered() are valid.
+template<std::size_t Num = 1, std::size_t Den = 4>
+struct hysteresis_shrink
+{
+    static_assert(Num != 0 && 2 * Num <= Den, "The shrink threshold must be in the range (0, 1/2].");
+
+    static constexpr std::size_t shrink_capacity(const shrink_params& params) noexcept
+    {
+        if (params.size >= params.capacity / Den * Num + params.capacity % Den * Num / Den) return params.capacity;
+
+        return std::max(2 * params.size, params.inline_capacity);
+    }
+};
+
+//------------------------------------------ STATISTICS POLICIES -----------------------------------------------------
+
+// The allocation events of a small_vector that are reported to its statistics policy.
+enum class stats_event : unsigned char
+{
+    allocate,               // New storage was allocated without relocating the elements (construction, assignment).
+    reallocate,             // The elements were moved to a new storage by reserve() or shrink_to_fit().
+    reallocate_append,      // The elements were moved to a new storage to append an element.
+    reallocate_emplace,     // The elements were moved to a new storage to insert an element.
+    reallocate_insert,      // The elements were moved to a new storage to insert a range of elements.
+    deallocate,             // The heap storage of the vector was released.
+    move,                   // The elements or the storage of the vector were moved to another vector, leaving it empty.
+    destroy                 // The vector is being destroyed.
+};
+
+// The parameters passed to the statistics policy of a small_vector along with the event.
+struct stats_params
+{
+    std::size_t size;               // The size of the vector before the event.
+    std::size_t old_capacity;       // The capacity of the vector before the event.
+    std::size_t new_capacity;       // The capacity requested from the allocator, or 0 if nothing is allocated.
+    std::size_t relocated_bytes;    // The number of bytes of elements moved from the old storage to the new one.
+    bool is_small;                  // The vector was using its inline buffer before the event (a spill if the event allocates).
+};
+
+// Statistics are not collected. The hooks are not instantiated at all with this policy, so it has no overhead.
+struct no_stats
+{
+    template<typename Vector>
+    static constexpr void record(stats_event, const stats_params&) noexcept {}
+};
+
+//------------------------------------------- SMALL VECTOR OPTIONS ----------------------------------------------------
+
+// The policies used by small_vector. Different policies can be specified by deriving from this
+// type and overriding the relevant member types.
+struct small_vector_options
+{
+    using layout = pointer_layout;
+    using alignment = natural_alignment;
+    using growth = growth_factor_1_5;
+    using shrink = no_shrink;
+    using stats = no_stats;
+};
+
+struct compact_small_vector_options : small_vector_options
+{
+    using layout = compact_layout<>;
+};
+
+// Tag type used to select the constructors of small_vector that default initialize the elements instead of
+// value initializing them, leaving trivial elements (e.g. ints) uninitialized.
+struct default_init_t { explicit default_init_t() = default; };
+
+inline constexpr default_init_t default_init{};
+
+
+namespace detail
+{
+    //---------------------------------------- STATISTICS RECORDERS -----------------------------------------------------
+
+    // Used by the vectors with the no_stats policy, which don't report any events.
+    struct no_stats_recorder {};
+
+    // Reports the events of a vector of type Vector to the statistics policy Stats.
+    template<typename Stats, typename Vector>
+    struct static_stats_recorder
+    {
+        void operator()(stats_event event, const stats_params& params) const noexcept
+        {
+            Stats::template record<Vector>(event, params);
+        }
+    };
+
+    // Reports the events to a record function selected at runtime, so the code using it doesn't depend on the type of
+    // the vector the events are attributed to.
+    struct dynamic_stats_recorder
+    {
+        void (*record)(stats_event, const stats_params&);
+
+        void operator()(stats_event event, const stats_params& params) const noexcept
+        {
+            record(event, params);
+        }
+    };
+
+    //----------------------------------------- SMALL VECTOR CORE -------------------------------------------------------
+
+    // The operations of small_vector that don't depend on the size of its inline buffer, similar to llvm::SmallVectorImpl.
+    // The core refers to the storage and the allocator of a vector, and to the location and capacity of its inline buffer.
+    // small_vector creates a core for each operation it forwards to it, and small_vector_ref stores one, so the vectors
+    // and the references to them share this implementation. Vectors that don't collect statistics also share the
+    // out-of-line instances of these functions for every Size.
+    template<typename T, typename A, typename Options, typename Recorder>
+    class small_vector_core
+    {
+    public:
+        using pointer         = typename std::allocator_traits<A>::pointer;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using iterator        = T*;
+        using const_iterator  = const T*;
+        using storage_type    = typename Options::layout::template storage_type<pointer>;
+
+        constexpr small_vector_core(storage_type& storage, A& alloc, pointer buffer, size_type inline_capacity, Recorder record = {}) noexcept :
+            storage_(std::addressof(storage)),
+            alloc_(std::addressof(alloc)),
+            buffer_(buffer),
+            inline_capacity_(inline_capacity),
+            record_(record)
+        {}
+
+        constexpr storage_type& storage() const noexcept { return *storage_; }
+        constexpr A& allocator() const noexcept { return *alloc_; }
+
+        constexpr size_type size() const noexcept { return storage_->size(); }
+        constexpr difference_type ssize() const noexcept { return difference_type(storage_->size()); }
+        constexpr size_type capacity() const noexcept { return storage_->capacity(); }
+        constexpr size_type max_size() const noexcept { return std::min<size_type>(std::allocator_traits<A>::max_size(*alloc_), storage_type::max_size()); }
+
+        constexpr bool is_small() const noexcept { return storage_->first() == buffer_; }
+        constexpr size_type inline_capacity() const noexcept { return inline_capacity_; }
+
+        constexpr void reserve(size_type new_capacity) const { if (new_capacity > capacity()) reallocate_n(next_capacity(new_capacity - capacity())); }
+
+        template<typename... Args>
+        constexpr T& emplace_back(Args&&... args) const
+        {
+            if (size() != capacity()) return emplace_back_unchecked(std::forward<Args>(args)...);
+            return *reallocate_append(next_capacity(), std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        constexpr T& emplace_back_unchecked(Args&&... args) const noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        {
+            const pointer last = storage_->last();
+            detail::construct(*alloc_, last, std::forward<Args>(args)...);
+            storage_->set_last(last + 1);
+            return *last;
+        }
+
+        constexpr void pop_back() const noexcept
+        {
+            assert(size() != 0);
+            storage_->set_last(storage_->last() - 1);
+            detail::destroy(*alloc_, storage_->last());
+            shrink_if_sparse();
+        }
+
+        template<typename... Args>
+        constexpr iterator emplace(const_iterator pos, Args&&... args) const
+        {
+            if (size() != capacity())
+            {
+                if (pos == storage_->last()) return std::addressof(emplace_back_unchecked(std::forward<Args>(args)...));
+
+                const difference_type offset = std::distance(cbegin(), pos);
+
+                if (detail::memcpy_relocatable_v<A, T> && !std::is_constant_evaluated())
+                {
+                    const pointer old_last = storage_->last();
+                    detail::construct(*alloc_, old_last, std::forward<Args>(args)...);
+                    storage_->set_last(old_last + 1);
+                    detail::rotate_relocatable(storage_->first() + offset, old_last, old_last + 1);
+                    return storage_->first() + offset;
+                }
+
+                detail::allocator_managed<T, A> new_elem(*alloc_, std::forward<Args>(args)...);
+
+                const pointer old_last = storage_->last();
+                detail::construct(*alloc_, old_last, std::move(*(old_last - 1)));
+                storage_->set_last(old_last + 1);
+                std::shift_right(storage_->first() + offset, old_last, 1);
+                *(storage_->first() + offset) = std::move(*new_elem);
+                return storage_->first() + offset;
+            }
+
+            return reallocate_emplace(next_capacity(), pos, std::forward<Args>(args)...);
+        }
+
+        constexpr iterator insert(const_iterator pos, size_type count, const T& value) const
+        {
+            if (capacity() - size() >= count)
+            {
+                const difference_type offset = std::distance(cbegin(), pos);
+                const difference_type src_size = difference_type(count);
+
+                if (detail::memcpy_relocatable_v<A, T> && !std::is_constant_evaluated())
+                {
+                    const pointer old_last = storage_->last();
+                    detail::construct_range(*alloc_, old_last, old_last + src_size, value);
+                    storage_->set_last(old_last + src_size);
+                    detail::rotate_relocatable(storage_->first() + offset, old_last, old_last + src_size);
+                    return storage_->first() + offset;
+                }
+
+                const auto middle = storage_->first() + std::max(ssize() - src_size, offset);
+                const auto moved_size = storage_->last() - middle;
+                const auto old_last   = storage_->last();
+                const auto new_last   = storage_->last() + src_size;
+                const auto new_middle = middle + src_size;
+
+                // The value may be an element of the vector, which would be moved from when the tail is shifted
+                const detail::allocator_managed<T, A> new_value(*alloc_, value);
+
+                detail::construct_range(*alloc_, storage_->last(), new_middle, *new_value);
+                storage_->set_last(new_middle);
+                detail::relocate_range_weak(*alloc_, middle, old_last, new_middle);
+                storage_->set_last(new_last);
+                std::move_backward(storage_->first() + offset, middle, old_last);
+                detail::assign_range(storage_->first() + offset, storage_->first() + offset + moved_size, *new_value);
+
+                return storage_->first() + offset;
+            }
+
+            return reallocate_insert(next_capacity(count), pos, count, value);
+        }
+
+        // insert src_size elements from a forward range
+        template<std::forward_iterator Iter>
+        constexpr iterator insert_n(const_iterator pos, Iter src_first, difference_type src_size) const
+        {
+            if (difference_type(capacity() - size()) >= src_size)
+            {
+                const difference_type offset = std::distance(cbegin(), pos);
+
+                if (detail::memcpy_relocatable_v<A, T> && !std::is_constant_evaluated())
+                {
+                    const pointer old_last = storage_->last();
+                    detail::construct_range(*alloc_, old_last, old_last + src_size, src_first);
+                    storage_->set_last(old_last + src_size);
+                    detail::rotate_relocatable(storage_->first() + offset, old_last, old_last + src_size);
+                    return storage_->first() + offset;
+                }
+
+                const auto middle = storage_->first() + std::max(ssize() - src_size, offset);
+                const auto moved_size = storage_->last() - middle;
+                const auto old_last   = storage_->last();
+                const auto new_last   = storage_->last() + src_size;
+                const auto new_middle = middle + src_size;
+
+                detail::construct_range(*alloc_, storage_->last(), new_middle, std::next(src_first, moved_size));
+                storage_->set_last(new_middle);
+                detail::relocate_range_weak(*alloc_, middle, old_last, new_middle);
+                storage_->set_last(new_last);
+                std::move_backward(storage_->first() + offset, middle, old_last);
+                detail::assign_range(storage_->first() + offset, storage_->first() + offset + moved_size, src_first);
+
+                return storage_->first() + offset;
+            }
+
+            return reallocate_insert(next_capacity(size_type(src_size)), pos, src_first, src_size);
+        }
+
+        // insert the elements of an input range of unknown size
+        template<std::input_iterator Iter, std::sentinel_for<Iter> Sent>
+        constexpr iterator insert_input(const_iterator pos, Iter src_first, Sent src_last) const
+        {
+            const auto offset = std::distance(cbegin(), pos);
+            const auto old_size = ssize();
+
+            for (; src_first != src_last; ++src_first) emplace_back(*src_first);
+
+            if (detail::memcpy_relocatable_v<A, T> && !std::is_constant_evaluated())
+            {
+                detail::rotate_relocatable(storage_->first() + offset, storage_->first() + old_size, storage_->last());
+            }
+            else
+            {
+                std::rotate(storage_->first() + offset, storage_->first() + old_size, storage_->last());
+            }
+
+            return storage_->first() + offset;
+        }
+
+        constexpr iterator erase(const_iterator first, const_iterator last) const noexcept(std::is_nothrow_move_assignable_v<T>)
+        {
+            const auto offset = std::distance(cbegin(), first);
+            const auto erase_first = storage_->first() + offset;
+            const auto erase_count = std::distance(first, last);
+
+            if (detail::memcpy_relocatable_v<A, T> && !std::is_constant_evaluated())
+            {
+                const auto erase_last = erase_first + erase_count;
+                detail::destroy_range(*alloc_, erase_first, erase_last);
+                std::memmove((void*)erase_first, (void*)erase_last, sizeof(T) * std::size_t(storage_->last() - erase_last));
+                storage_->set_last(storage_->last() - erase_count);
+            }
+            else
+            {
+                const auto new_last = std::shift_left(erase_first, storage_->last(), erase_count);
+                detail::destroy_range(*alloc_, new_last, storage_->last());
+                storage_->set_last(new_last);
+            }
+
+            if (erase_count) shrink_if_sparse();
+
+            return storage_->first() + offset;
+        }
+
+        template<typename... Args>
+        constexpr void resize(size_type count, Args&&... args) const
+        {
+            if (count <= size())
+            {
+                detail::destroy_range(*alloc_, storage_->first() + count, storage_->last());
+                storage_->set_size(count);
+                shrink_if_sparse();
+            }
+            else
+            {
+                reserve(count);
+                detail::construct_range(*alloc_, storage_->last(), storage_->first() + count, std::forward<Args>(args)...);
+                storage_->set_size(count);
+            }
+        }
+
+        // Set up an empty vector with room for count elements, in the inline buffer if they fit in it.
+        constexpr void allocate_n(size_type count) const
+        {
+            storage_->set(buffer_, 0, inline_capacity_);
+            if (count <= inline_capacity_) return;
+
+            // The vector starts out in the inline buffer, so allocating the storage directly is a spill
+            record_stats(stats_event::allocate, count);
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(*alloc_, count, storage_type::max_size());
+            storage_->set(alloc_result.data, 0, alloc_result.size);
+        }
+
+        constexpr void reallocate_n(size_type new_capacity) const
+        {
+            record_stats(stats_event::reallocate, new_capacity, size());
+
+            if constexpr (detail::can_reallocate_v<A, T>)
+            {
+                if (!std::is_constant_evaluated() && !is_small()) return reallocate_heap(new_capacity);
+            }
+
+            const size_type old_size = size();
+
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(*alloc_, new_capacity, storage_type::max_size());
+            detail::scope_exit guard{ [&] { detail::deallocate(*alloc_, alloc_result.data, alloc_result.size); } };
+            detail::relocate_range_strong(*alloc_, storage_->first(), storage_->last(), alloc_result.data);
+            detail::destroy_relocated_range(*alloc_, storage_->first(), storage_->last());
             guard.release();
             deallocate();
-            set_storage(alloc_result.data, src_size, alloc_result.size);
+            storage_->set(alloc_result.data, old_size, alloc_result.size);
+        }
+
+        template<typename... Args>
+        constexpr iterator reallocate_append(size_type new_capacity, Args&&... args) const
+        {
+            record_stats(stats_event::reallocate_append, new_capacity, size());
+
+            if constexpr (detail::can_reallocate_v<A, T> && std::is_constructible_v<T, Args...>)
+            {
+                if (!std::is_constant_evaluated() && !is_small())
+                {
+                    // args may refer to an element of the vector, which is invalidated by the reallocation
+                    T value(std::forward<Args>(args)...);
+                    reallocate_heap(new_capacity);
+                    return std::addressof(emplace_back_unchecked(std::move(value)));
+                }
+            }
+
+            const size_type old_size = size();
+
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(*alloc_, new_capacity, storage_type::max_size());
+            detail::scope_exit guard1{ [&] { detail::deallocate(*alloc_, alloc_result.data, alloc_result.size); } };
+            detail::construct(*alloc_, alloc_result.data + old_size, std::forward<Args>(args)...);
+            detail::scope_exit guard2{ [&] { detail::destroy(*alloc_, alloc_result.data + old_size); } };
+            detail::relocate_range_strong(*alloc_, storage_->first(), storage_->last(), alloc_result.data);
+            { guard1.release(); guard2.release(); }
+            detail::destroy_relocated_range(*alloc_, storage_->first(), storage_->last());
+            deallocate();
+            storage_->set(alloc_result.data, old_size + 1, alloc_result.size);
+
+            return alloc_result.data + old_size;
+        }
+
+        template<typename... Args>
+        constexpr iterator reallocate_emplace(size_type new_capacity, const_iterator pos, Args&&... args) const
+        {
+            record_stats(stats_event::reallocate_emplace, new_capacity, size());
+
+            const size_type old_size = size();
+            const difference_type offset = std::distance(cbegin(), pos);
+
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(*alloc_, new_capacity, storage_type::max_size());
+            detail::scope_exit guard1{ [&] { detail::deallocate(*alloc_, alloc_result.data, alloc_result.size); } };
+            detail::construct(*alloc_, alloc_result.data + offset, std::forward<Args>(args)...);
+            detail::scope_exit guard2{ [&] { detail::destroy(*alloc_, alloc_result.data + offset); } };
+            detail::relocate_range_strong(*alloc_, storage_->first(), storage_->first() + offset, alloc_result.data);
+            detail::scope_exit guard3{ [&] { detail::destroy_relocated_range(*alloc_, alloc_result.data, alloc_result.data + offset); } };
+            detail::relocate_range_strong(*alloc_, storage_->first() + offset, storage_->last(), alloc_result.data + offset + 1);
+            { guard1.release(); guard2.release(); guard3.release(); }
+            detail::destroy_relocated_range(*alloc_, storage_->first(), storage_->last());
+            deallocate();
+            storage_->set(alloc_result.data, old_size + 1, alloc_result.size);
+
+            return alloc_result.data + offset;
+        }
+
+        constexpr iterator reallocate_insert(size_type new_capacity, const_iterator pos, size_type count, const T& value) const
+        {
+            record_stats(stats_event::reallocate_insert, new_capacity, size());
+
+            const size_type old_size = size();
+            const difference_type src_size = difference_type(count);
+            const difference_type offset = std::distance(cbegin(), pos);
+
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(*alloc_, new_capacity, storage_type::max_size());
+            detail::scope_exit guard1{ [&] { detail::deallocate(*alloc_, alloc_result.data, alloc_result.size); } };
+            detail::relocate_range_weak(*alloc_, storage_->first(), storage_->first() + offset, alloc_result.data);
+            detail::scope_exit guard2{ [&] { detail::destroy_relocated_range(*alloc_, alloc_result.data, alloc_result.data + offset); } };
+            detail::construct_range(*alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size, value);
+            detail::scope_exit guard3{ [&] { detail::destroy_range(*alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size); } };
+            detail::relocate_range_weak(*alloc_, storage_->first() + offset, storage_->last(), alloc_result.data + offset + src_size);
+            { guard1.release(); guard2.release(); guard3.release(); }
+            detail::destroy_relocated_range(*alloc_, storage_->first(), storage_->last());
+            deallocate();
+            storage_->set(alloc_result.data, old_size + count, alloc_result.size);
+
+            return alloc_result.data + offset;
+        }
+
+        template<std::forward_iterator Iter>
+        constexpr iterator reallocate_insert(size_type new_capacity, const_iterator pos, Iter src_first, difference_type src_size) const
+        {
+            record_stats(stats_event::reallocate_insert, new_capacity, size());
+
+            const size_type old_size = size();
+            const difference_type offset = std::distance(cbegin(), pos);
+
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(*alloc_, new_capacity, storage_type::max_size());
+            detail::scope_exit guard1{ [&] { detail::deallocate(*alloc_, alloc_result.data, alloc_result.size); } };
+            detail::relocate_range_weak(*alloc_, storage_->first(), storage_->first() + offset, alloc_result.data);
+            detail::scope_exit guard2{ [&] { detail::destroy_relocated_range(*alloc_, alloc_result.data, alloc_result.data + offset); } };
+            detail::construct_range(*alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size, src_first);
+            detail::scope_exit guard3{ [&] { detail::destroy_range(*alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size); } };
+            detail::relocate_range_weak(*alloc_, storage_->first() + offset, storage_->last(), alloc_result.data + offset + src_size);
+            { guard1.release(); guard2.release(); guard3.release(); }
+            detail::destroy_relocated_range(*alloc_, storage_->first(), storage_->last());
+            deallocate();
+            storage_->set(alloc_result.data, old_size + size_type(src_size), alloc_result.size);
+
+            return alloc_result.data + offset;
+        }
+
+        constexpr void reallocate_heap(size_type new_capacity) const requires(detail::can_reallocate_v<A, T>)
+        {
+            assert(!is_small());
+
+            const size_type old_size = size();
+            pointer new_data = alloc_->reallocate(storage_->first(), capacity(), new_capacity);
+            storage_->set(new_data, old_size, new_capacity);
+        }
+
+        // Move the elements into a smaller storage, or the inline buffer if they fit in it.
+        constexpr void shrink_storage(size_type new_capacity) const
+        {
+            assert(!is_small() && size() <= new_capacity);
+
+            if (new_capacity > inline_capacity_)
+            {
+                // the memory of the old allocation wouldn't be released, so moving the elements is pointless
+                if constexpr (detail::has_trivial_deallocate<A>) return;
+                else return reallocate_n(new_capacity);
+            }
+
+            const size_type old_size = size();
+
+            detail::relocate_range_strong(*alloc_, storage_->first(), storage_->last(), buffer_);
+            detail::destroy_relocated_range(*alloc_, storage_->first(), storage_->last());
+            deallocate();
+            storage_->set(buffer_, old_size, inline_capacity_);
+        }
+
+        // Release some of the heap storage of the vector after elements were removed from it, if the shrink policy allows it.
+        // Shrinking is only an optimization, so the vector is left unchanged if it fails.
+        constexpr void shrink_if_sparse() const noexcept
+        {
+            if constexpr (std::is_move_constructible_v<T> && !detail::has_trivial_deallocate<A>)
+            {
+                if (is_small()) return;
+
+                const shrink_params params{ size(), capacity(), inline_capacity_, sizeof(T) };
+                const std::size_t new_capacity = std::max(Options::shrink::shrink_capacity(params), params.size);
+
+                if (new_capacity >= params.capacity) return;
+
+                try { shrink_storage(size_type(new_capacity)); }
+                catch (...) {}
+            }
+        }
+
+        constexpr void deallocate() const noexcept
+        {
+            if constexpr (!detail::has_trivial_deallocate<A>)
+            {
+                if (!is_small() && storage_->first())
+                {
+                    record_stats(stats_event::deallocate, 0);
+                    detail::deallocate(*alloc_, storage_->first(), capacity());
+                }
+            }
+        }
+
+        // Report an allocation event to the statistics policy of the vector. This is a no-op with the default policy.
+        constexpr void record_stats(stats_event event, size_type new_capacity, size_type relocated_count = 0) const noexcept
+        {
+            if constexpr (!std::is_same_v<typename Options::stats, no_stats>)
+            {
+                if (std::is_constant_evaluated()) return;
+
+                const stats_params params{ size(), capacity(), new_capacity, relocated_count * sizeof(T), is_small() };
+                record_(event, params);
+            }
+        }
+
+        constexpr size_type next_capacity(size_type min_growth = 1) const
+        {
+            const size_type current_capacity = capacity();
+            const size_type max_capacity     = max_size();
+
+            if (min_growth > max_capacity - current_capacity)
+            {
+                throw std::length_error{ "Too big vector." };
+            }
+
+            const growth_params params{ current_capacity, current_capacity + min_growth, max_capacity, sizeof(T), is_small() };
+            const size_type new_capacity = Options::growth::next_capacity(params);
+
+            return std::clamp(new_capacity, params.min_capacity, max_capacity);
+        }
+
+    private:
+        storage_type* storage_;
+        A* alloc_;
+        pointer buffer_;
+        size_type inline_capacity_;
+        SV_NO_UNIQUE_ADDRESS Recorder record_;
+
+
+        constexpr const_iterator cbegin() const noexcept { return storage_->first(); }
+    };
+
+} // namespace detail
+
+
+template<typename T, typename A, typename Options>
+class small_vector_ref;
+
+template<typename T, std::size_t Size = detail::default_small_size_v<T>, typename A = std::allocator<T>, typename Options = small_vector_options>
+class small_vector
+{
+public:
+    using value_type      = T;
+    using allocator_type  = A;
+    using reference       = T&;
+    using const_reference = const T&;
+    using pointer         = typename std::allocator_traits<A>::pointer;
+    using const_pointer   = typename std::allocator_traits<A>::const_pointer;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using iterator               = T*;
+    using const_iterator         = const T*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static_assert(Size, "The size of the inline buffer must be at least 1.");
+    static_assert(std::has_single_bit(Options::alignment::min_alignment), "The alignment of the inline buffer must be a power of 2.");
+
+    //-----------------------------------//
+    //            CONSTRUCTORS           //
+    //-----------------------------------//
+
+    constexpr small_vector() noexcept(std::is_nothrow_default_constructible_v<A>) :
+        storage_(buffer_.begin(), 0, buffer_capacity)
+    {}
+
+    constexpr explicit small_vector(const A& allocator) noexcept(std::is_nothrow_copy_constructible_v<A>) :
+        storage_(buffer_.begin(), 0, buffer_capacity),
+        alloc_(allocator)
+    {}
+
+    constexpr explicit small_vector(size_type count, const A& allocator = A()) :
+        alloc_(allocator)
+    {
+        core().allocate_n(count);
+        detail::scope_exit guard{ [&] { core().deallocate(); } };
+        detail::construct_range(alloc_, storage_.first(), storage_.first() + count);
+        storage_.set_size(count);
+        guard.release();
+    }
+
+    constexpr small_vector(size_type count, default_init_t, const A& allocator = A()) :
+        alloc_(allocator)
+    {
+        core().allocate_n(count);
+        detail::scope_exit guard{ [&] { core().deallocate(); } };
+        detail::default_init_range(alloc_, storage_.first(), storage_.first() + count);
+        storage_.set_size(count);
+        guard.release();
+    }
+
+    constexpr small_vector(size_type count, const T& value, const A& allocator = A()) :
+        alloc_(allocator)
+    {
+        core().allocate_n(count);
+        detail::scope_exit guard{ [&] { core().deallocate(); } };
+        detail::construct_range(alloc_, storage_.first(), storage_.first() + count, value);
+        storage_.set_size(count);
+        guard.release();
+    }
+
+    template<std::forward_iterator Iter>
+    constexpr small_vector(Iter src_first, Iter src_last, const A& allocator = A()) :
+        alloc_(allocator)
+    {
+        const auto src_len = std::distance(src_first, src_last);
+        core().allocate_n(src_len);
+        detail::scope_exit guard{ [&] { core().deallocate(); } };
+        detail::construct_range(alloc_, storage_.first(), storage_.first() + src_len, src_first);
+        storage_.set_size(size_type(src_len));
+        guard.release();
+    }
+
+    template<std::input_iterator Iter>
+    constexpr small_vector(Iter src_first, Iter src_last, const A& allocator = A()) :
+        storage_(buffer_.begin(), 0, buffer_capacity),
+        alloc_(allocator)
+    {
+        while (src_first != src_last) emplace_back(*src_first++);
+    }
+
+    constexpr small_vector(std::initializer_list<T> init, const A& allocator = A()) :
+        small_vector(init.begin(), init.end(), allocator)
+    {}
+
+#if __cpp_lib_containers_ranges
+    template<detail::container_compatible_range<T> R>
+    constexpr small_vector(std::from_range_t, R&& range, const A& allocator = A()) :
+        small_vector(allocator)
+    {
+        append_range(std::forward<R>(range));
+    }
+#endif
+
+    constexpr small_vector(const small_vector& other) :
+        small_vector(std::allocator_traits<A>::select_on_container_copy_construction(other.alloc_))
+    {
+        if (fixed_size_buffer_copy && other.is_small() && !std::is_constant_evaluated())
+        {
+            std::memcpy((void*)buffer_.begin(), (const void*)other.buffer_.begin(), sizeof(buffer_));
+            set_buffer_storage(other.size());
+            return;
+        }
+
+        core().allocate_n(other.size());
+        detail::construct_range(alloc_, storage_.first(), storage_.first() + other.size(), other.storage_.first());
+        storage_.set_size(other.size());
+    }
+
+    constexpr small_vector(const small_vector& other, const A& allocator) :
+        small_vector(other.begin(), other.end(), allocator)
+    {}
+
+    constexpr small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T> && detail::has_trivial_construct_v<A&, T, T&&>) :
+        alloc_(std::move(other.alloc_))
+    {
+        other.core().record_stats(stats_event::move, 0);
+
+        if (fixed_size_buffer_relocation && other.is_small() && !std::is_constant_evaluated())
+        {
+            std::memcpy((void*)buffer_.begin(), (void*)other.buffer_.begin(), sizeof(buffer_));
+            set_buffer_storage(other.size());
+            other.storage_.set_size(0);
+        }
+        else if (other.is_small())
+        {
+            set_buffer_storage(0);
+            detail::relocate_range_weak(alloc_, other.storage_.first(), other.storage_.last(), storage_.first());
+            detail::destroy_relocated_range(alloc_, other.storage_.first(), other.storage_.last());
+            set_buffer_storage(other.size());
+            other.storage_.set_size(0);
+        }
+        else
+        {
+            storage_ = other.storage_;
+            other.set_buffer_storage(0);
+        }
+    }
+
+    constexpr small_vector(small_vector&& other, const A& allocator) :
+        small_vector(allocator)
+    {
+        if (!other.is_small() && (std::allocator_traits<A>::is_always_equal::value || alloc_ == other.alloc_))
+        {
+            other.core().record_stats(stats_event::move, 0);
+            storage_ = other.storage_;
+            other.set_buffer_storage(0);
+            return;
+        }
+
+        // the elements have to be moved one by one if the allocator of other can't deallocate its storage,
+        // but other keeps its storage, and only the moved-from elements are destroyed
+        core().allocate_n(other.size());
+        detail::scope_exit guard{ [&] { core().deallocate(); } };
+        detail::relocate_range_weak(alloc_, other.storage_.first(), other.storage_.last(), storage_.first());
+        guard.release();
+        other.core().record_stats(stats_event::move, 0);
+        detail::destroy_relocated_range(other.alloc_, other.storage_.first(), other.storage_.last());
+        storage_.set_size(other.size());
+        other.storage_.set_size(0);
+    }
+
+    //-----------------------------------//
+    //             DESTRUCTOR            //
+    //-----------------------------------//
+
+    constexpr ~small_vector() noexcept
+    {
+        core().record_stats(stats_event::destroy, 0);
+        detail::destroy_range(alloc_, storage_.first(), storage_.last());
+        core().deallocate();
+    }
+
+    //-----------------------------------//
+    //             ASSIGNMENT            //
+    //-----------------------------------//
+
+    constexpr void assign(size_type count, const T& value)
+    {
+        const auto src_size = difference_type(count);
+        const auto old_size = ssize();
+        const auto com_size = std::min(old_size, src_size);
+
+        if (capacity() >= count)
+        {
+            detail::assign_range(storage_.first(), storage_.first() + com_size, value);
+            detail::construct_range(alloc_, storage_.first() + com_size, storage_.first() + src_size, value);
+            detail::destroy_range(alloc_, storage_.first() + com_size, storage_.last());
+            storage_.set_size(size_type(src_size));
+        }
+        else
+        {
+            size_type new_cap = core().next_capacity(src_size - old_size);
+            core().record_stats(stats_event::allocate, new_cap);
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_cap, storage_type::max_size());
+            detail::scope_exit guard{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
+            detail::construct_range(alloc_, alloc_result.data, alloc_result.data + src_size, value);
+            detail::destroy_range(alloc_, storage_.first(), storage_.last());
+            guard.release();
+            core().deallocate();
+            set_storage(alloc_result.data, count, alloc_result.size);
         }
     }
 
+    template<std::forward_iterator Iter>
+    constexpr void assign(Iter src_first, Iter src_last)
+    {
+        assign_n(src_first, std::distance(src_first, src_last));
+    }
+
     template<std::input_iterator Iter>
     constexpr void assign(Iter src_first, Iter src_last)
     {
-        pointer next = first_;
-        while (next != last_ && src_first != src_last) { *next++ = *src_first++; }
+        pointer next = storage_.first();
+        while (next != storage_.last() && src_first != src_last) { *next++ = *src_first++; }
 
-        detail::destroy_range(alloc_, next, last_);
-        last_ = next;
+        detail::destroy_range(alloc_, next, storage_.last());
+        storage_.set_last(next);
 
         while (src_first != src_last) { emplace_back(*src_first++); }
     }
@@ -559,6 +2539,20 @@ public:
         assign(list.begin(), list.end());
     }
 
+    template<detail::container_compatible_range<T> R>
+    constexpr void assign_range(R&& range)
+    {
+        if constexpr (std::ranges::forward_range<R>)
+        {
+            assign_n(std::ranges::begin(range), difference_type(std::ranges::distance(range)));
+        }
+        else
+        {
+            clear();
+            append_range(std::forward<R>(range));
+        }
+    }
+
     constexpr small_vector& operator=(const small_vector& other)
     {
         if (std::addressof(other) == this) [[unlikely]] return *this;
@@ -569,9 +2563,9 @@ public:
             {
                 reset();
                 alloc_ = other.alloc_;
-                allocate_n(other.size());
-                detail::construct_range(alloc_, first_, first_ + other.size(), other.first_);
-                last_ = first_ + other.size();
+                core().allocate_n(other.size());
+                detail::construct_range(alloc_, storage_.first(), storage_.first() + other.size(), other.storage_.first());
+                storage_.set_size(other.size());
                 return *this;
             }
         }
@@ -587,14 +2581,26 @@ public:
     {
         if (std::addressof(other) == this) [[unlikely]] return *this;
 
-        if (!this->is_small() && !other.is_small())
+        // the allocations can only be exchanged if the allocator of this vector will be able to deallocate the storage of other
+        if (!this->is_small() && !other.is_small() && (detail::steal_pointers_v<A> || alloc_ == other.alloc_))
         {
             using std::swap;
 
             if constexpr (detail::move_allocators_v<A>) swap(alloc_, other.alloc_);
-            swap(first_, other.first_);
-            swap(last_, other.last_);
-            swap(last_alloc_, other.last_alloc_);
+            swap(storage_, other.storage_);
+
+            return *this;
+        }
+
+        if (fixed_size_buffer_relocation && this->is_small() && other.is_small() && !std::is_constant_evaluated())
+        {
+            other.core().record_stats(stats_event::move, 0);
+            detail::destroy_range(alloc_, storage_.first(), storage_.last());
+            std::memcpy((void*)buffer_.begin(), (void*)other.buffer_.begin(), sizeof(buffer_));
+            set_buffer_storage(other.size());
+            other.storage_.set_size(0);
+
+            if constexpr (detail::move_allocators_v<A>) alloc_ = std::move(other.alloc_);
 
             return *this;
         }
@@ -603,16 +2609,18 @@ public:
         {
             if constexpr (detail::steal_pointers_v<A>)
             {
-                detail::destroy_range(alloc_, first_, last_);
-                this->set_storage(other.first_, other.last_, other.last_alloc_);
+                other.core().record_stats(stats_event::move, 0);
+                detail::destroy_range(alloc_, storage_.first(), storage_.last());
+                this->storage_ = other.storage_;
                 other.set_buffer_storage(0);
                 alloc_ = std::move(other.alloc_);
                 return *this;
             }
             else if (alloc_ == other.alloc_)
             {
-                detail::destroy_range(alloc_, first_, last_);
-                this->set_storage(other.first_, other.last_, other.last_alloc_);
+                other.core().record_stats(stats_event::move, 0);
+                detail::destroy_range(alloc_, storage_.first(), storage_.last());
+                this->storage_ = other.storage_;
                 other.set_buffer_storage(0);
                 return *this;
             }
@@ -623,16 +2631,17 @@ public:
             if (alloc_ != other.alloc_)
             {
                 reset();
-                detail::relocate_range_weak(other.alloc_, other.first_, other.last_, first_);
-                last_ = first_ + other.size();
-                detail::destroy_range(other.alloc_, other.first_, other.last_);
+                detail::relocate_range_weak(other.alloc_, other.storage_.first(), other.storage_.last(), storage_.first());
+                storage_.set_size(other.size());
+                other.core().record_stats(stats_event::move, 0);
+                detail::destroy_relocated_range(other.alloc_, other.storage_.first(), other.storage_.last());
                 other.set_buffer_storage(0);
                 alloc_ = std::move(other.alloc_);
                 return *this;
             }
         }
 
-        assign(std::make_move_iterator(other.first_), std::make_move_iterator(other.last_));
+        assign(std::make_move_iterator(other.storage_.first()), std::make_move_iterator(other.storage_.last()));
         return *this;
     }
 
@@ -646,21 +2655,21 @@ public:
     //             ITERATORS             //
     //-----------------------------------//
 
-    constexpr iterator begin() noexcept { return first_; }
-    constexpr const_iterator begin() const noexcept { return first_; }
-    constexpr const_iterator cbegin() const noexcept { return first_; }
+    constexpr iterator begin() noexcept { return storage_.first(); }
+    constexpr const_iterator begin() const noexcept { return storage_.first(); }
+    constexpr const_iterator cbegin() const noexcept { return storage_.first(); }
 
-    constexpr iterator end() noexcept { return last_; }
-    constexpr const_iterator end() const noexcept { return last_; }
-    constexpr const_iterator cend() const noexcept { return last_; }
+    constexpr iterator end() noexcept { return storage_.last(); }
+    constexpr const_iterator end() const noexcept { return storage_.last(); }
+    constexpr const_iterator cend() const noexcept { return storage_.last(); }
 
-    constexpr reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(last_); }
-    constexpr const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(last_); }
-    constexpr const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(last_); }
+    constexpr reverse_iterator rbegin() noexcept { return std::make_reverse_iterator(storage_.last()); }
+    constexpr const_reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(storage_.last()); }
+    constexpr const_reverse_iterator crbegin() const noexcept { return std::make_reverse_iterator(storage_.last()); }
 
-    constexpr reverse_iterator rend() noexcept { return std::make_reverse_iterator(first_); }
-    constexpr const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(first_); }
-    constexpr const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(first_); }
+    constexpr reverse_iterator rend() noexcept { return std::make_reverse_iterator(storage_.first()); }
+    constexpr const_reverse_iterator rend() const noexcept { return std::make_reverse_iterator(storage_.first()); }
+    constexpr const_reverse_iterator crend() const noexcept { return std::make_reverse_iterator(storage_.first()); }
 
     //-----------------------------------//
     //           ELEMENT ACCESS          //
@@ -669,52 +2678,82 @@ public:
     constexpr reference operator[](size_type pos) noexcept
     {
         assert(pos < size());
-        return first_[pos];
+        return storage_.first()[pos];
     }
 
     constexpr const_reference operator[](size_type pos) const noexcept
     {
         assert(pos < size());
-        return first_[pos];
+        return storage_.first()[pos];
     }
      
     constexpr reference at(size_type pos)
     {
         if (pos >= size()) throw std::out_of_range{ "Bad vector index." };
-        return first_[pos];
+        return storage_.first()[pos];
     }
 
     constexpr const_reference at(size_type pos) const
     {
         if (pos >= size()) throw std::out_of_range{ "Bad vector index." };
-        return first_[pos];
+        return storage_.first()[pos];
+    }
+
+    constexpr reference front() noexcept { assert(!empty()); return *storage_.first(); }
+    constexpr const_reference front() const noexcept { assert(!empty()); return *storage_.first(); }
+
+    constexpr reference back() noexcept { assert(!empty()); return *(storage_.last() - 1); }
+    constexpr const_reference back() const noexcept { assert(!empty()); return *(storage_.last() - 1); }
+
+    constexpr pointer data() noexcept { return storage_.first(); }
+    constexpr const_pointer data() const noexcept { return storage_.first(); }
+
+    //-----------------------------------//
+    //               LOOKUP              //
+    //-----------------------------------//
+
+    // Return the index of the first element equal to value, or size() if there is no such element.
+    constexpr size_type index_of(const T& value) const
+    {
+        if constexpr (fixed_size_find)
+        {
+            if (is_small()) return size_type(detail::find_fixed<buffer_capacity>(buffer_.begin(), size(), value));
+        }
+        return size_type(detail::find(storage_.first(), storage_.last(), value) - storage_.first());
     }
 
-    constexpr reference front() noexcept { assert(!empty()); return *first_; }
-    constexpr const_reference front() const noexcept { assert(!empty()); return *first_; }
+    // Return an iterator to the first element equal to value, or end() if there is no such element.
+    constexpr iterator find(const T& value) { return storage_.first() + index_of(value); }
+    constexpr const_iterator find(const T& value) const { return storage_.first() + index_of(value); }
 
-    constexpr reference back() noexcept { assert(!empty()); return *(last_ - 1); }
-    constexpr const_reference back() const noexcept { assert(!empty()); return *(last_ - 1); }
+    constexpr bool contains(const T& value) const { return index_of(value) != size(); }
 
-    constexpr pointer data() noexcept { return first_; }
-    constexpr const_pointer data() const noexcept { return first_; }
+    // Return the number of elements equal to value.
+    constexpr size_type count(const T& value) const
+    {
+        if constexpr (fixed_size_find)
+        {
+            if (is_small()) return size_type(detail::count_fixed<buffer_capacity>(buffer_.begin(), size(), value));
+        }
+        return size_type(detail::count(storage_.first(), storage_.last(), value));
+    }
 
     //-----------------------------------//
     //              CAPACITY             //
     //-----------------------------------//
 
-    constexpr bool empty() const noexcept { return first_ == last_; }
+    constexpr bool empty() const noexcept { return storage_.size() == 0; }
 
-    constexpr size_type size() const noexcept { return size_type(last_ - first_); }
-    constexpr difference_type ssize() const noexcept { return last_ - first_; }
-    constexpr size_type capacity() const noexcept { return size_type(last_alloc_ - first_); }
-    constexpr size_type max_size() const noexcept { return std::allocator_traits<A>::max_size(alloc_); }
+    constexpr size_type size() const noexcept { return storage_.size(); }
+    constexpr difference_type ssize() const noexcept { return difference_type(storage_.size()); }
+    constexpr size_type capacity() const noexcept { return storage_.capacity(); }
+    constexpr size_type max_size() const noexcept { return std::min<size_type>(std::allocator_traits<A>::max_size(alloc_), storage_type::max_size()); }
     
-    constexpr bool is_small() const noexcept { return first_ == buffer_.begin(); }
-    static constexpr size_type inline_capacity() noexcept { return Size; }
+    constexpr bool is_small() const noexcept { return storage_.first() == buffer_.begin(); }
+    static constexpr size_type inline_capacity() noexcept { return buffer_capacity; }
 
-    constexpr void reserve(size_type new_capacity) { if (new_capacity > capacity()) reallocate_n(next_capacity(new_capacity - capacity())); }
-    constexpr void shrink_to_fit() { if (size() > inline_capacity()) reallocate_n(size()); }
+    constexpr void reserve(size_type new_capacity) { core().reserve(new_capacity); }
+    constexpr void shrink_to_fit() { if (!is_small() && size() != capacity()) core().shrink_storage(size()); }
 
     //-----------------------------------//
     //             MODIFIERS             //
@@ -722,14 +2761,14 @@ public:
 
     constexpr void clear() noexcept
     {
-        detail::destroy_range(alloc_, first_, last_);
-        last_ = first_;
+        detail::destroy_range(alloc_, storage_.first(), storage_.last());
+        storage_.set_size(0);
     }
 
     constexpr void reset() noexcept
     {
-        detail::destroy_range(alloc_, first_, last_);
-        deallocate();
+        detail::destroy_range(alloc_, storage_.first(), storage_.last());
+        core().deallocate();
         set_buffer_storage(0);
     }
 
@@ -738,11 +2777,20 @@ public:
     {
         if (std::addressof(other) == this) [[unlikely]] return;
 
+        assert((detail::swap_allocators_v<A> || alloc_ == other.alloc_) && "The allocators of the vectors must be equal if they don't propagate.");
+
         if (!this->is_small() && !other.is_small())
         {
-            std::swap(first_, other.first_);
-            std::swap(last_, other.last_);
-            std::swap(last_alloc_, other.last_alloc_);
+            std::swap(storage_, other.storage_);
+        }
+        else if (fixed_size_buffer_relocation && this->is_small() && other.is_small() && !std::is_constant_evaluated())
+        {
+            const size_type old_size = size();
+
+            detail::swap_bytes<sizeof(buffer_)>(buffer_.begin(), other.buffer_.begin());
+
+            set_buffer_storage(other.size());
+            other.set_buffer_storage(old_size);
         }
         else if (this->is_small() && other.is_small())
         {
@@ -750,9 +2798,16 @@ public:
             small_vector& small = (this->size() < other.size()) ? *this : other;
             const auto small_size = small.size();
 
-            std::swap_ranges(small.first_, small.last_, big.first_);
-            detail::relocate_range_strong(big.alloc_, big.first_ + small.size(), big.last_, small.last_);
-            detail::destroy_range(big.alloc_, big.first_ + small.size(), big.last_);
+            if (detail::memcpy_relocatable_v<A, T> && !std::is_constant_evaluated())
+            {
+                detail::swap_bytes((void*)small.storage_.first(), (void*)big.storage_.first(), sizeof(T) * big.size());
+            }
+            else
+            {
+                std::swap_ranges(small.storage_.first(), small.storage_.last(), big.storage_.first());
+                detail::relocate_range_strong(big.alloc_, big.storage_.first() + small.size(), big.storage_.last(), small.storage_.last());
+                detail::destroy_relocated_range(big.alloc_, big.storage_.first() + small.size(), big.storage_.last());
+            }
 
             small.set_buffer_storage(big.size());
             big.set_buffer_storage(small_size);
@@ -763,10 +2818,17 @@ public:
             small_vector& small = this->is_small() ? *this : other;
             const auto small_size = small.size();
 
-            detail::relocate_range_strong(small.alloc_, small.first_, small.last_, big.buffer_.begin());
-            detail::destroy_range(small.alloc_, small.first_, small.last_);
+            if (fixed_size_buffer_relocation && !std::is_constant_evaluated())
+            {
+                std::memcpy((void*)big.buffer_.begin(), (void*)small.buffer_.begin(), sizeof(buffer_));
+            }
+            else
+            {
+                detail::relocate_range_strong(small.alloc_, small.storage_.first(), small.storage_.last(), big.buffer_.begin());
+                detail::destroy_relocated_range(small.alloc_, small.storage_.first(), small.storage_.last());
+            }
 
-            small.set_storage(big.first_, big.last_, big.last_alloc_);
+            small.storage_ = big.storage_;
             big.set_buffer_storage(small_size);
         }
 
@@ -786,21 +2848,68 @@ public:
     template<typename... Args>
     constexpr reference emplace_back(Args&&... args)
     {
-        if (last_ != last_alloc_) return emplace_back_unchecked(std::forward<Args>(args)...);
-        return *reallocate_append(next_capacity(), std::forward<Args>(args)...);
+        return core().emplace_back(std::forward<Args>(args)...);
     }
 
     template<typename... Args>
     constexpr reference emplace_back_unchecked(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
     {
-        detail::construct(alloc_, last_, std::forward<Args>(args)...);
-        return *last_++;
+        return core().emplace_back_unchecked(std::forward<Args>(args)...);
+    }
+
+    // With a shrink policy other than no_shrink, pop_back() and reducing the size with resize() may reallocate
+    // the vector, which invalidates all iterators and references to its elements.
+    constexpr void pop_back() noexcept
+    {
+        assert(!empty());
+        core().pop_back();
+    }
+
+    constexpr void resize(size_type count) { core().resize(count); }
+    constexpr void resize(size_type count, const T& value) { core().resize(count, value); }
+
+    // Same as resize(count), but the new elements are default initialized, so trivial elements are left uninitialized.
+    constexpr void resize_default_init(size_type count)
+    {
+        if (count <= size()) return core().resize(count);
+
+        reserve(count);
+        detail::default_init_range(alloc_, storage_.last(), storage_.first() + count);
+        storage_.set_size(count);
+    }
+
+    constexpr void resize_for_overwrite(size_type count) { resize_default_init(count); }
+
+    // Resize the vector to at most count elements, and let op overwrite the contents of the vector, similar to
+    // std::basic_string::resize_and_overwrite. op is called with data() and count, and must return the new size of the
+    // vector, which must be in the range [0, count]. The elements after the old size are uninitialized when op is called.
+    template<typename Op>
+    constexpr void resize_and_overwrite(size_type count, Op op)
+    requires(detail::can_leave_uninitialized_v<A, T>)
+    {
+        reserve(count);
+        const auto new_size = size_type(std::move(op)(storage_.first(), count));
+        assert(new_size <= count);
+        storage_.set_size(new_size);
     }
 
-    constexpr void pop_back() noexcept { assert(!empty()); detail::destroy(alloc_, last_--); }
+    // Reserve storage for count more elements after the end of the vector, and return the uninitialized storage.
+    // The elements written to the start of this storage can be added to the vector by calling commit().
+    // Other operations that modify the vector invalidate the returned span.
+    constexpr std::span<T> append_uninitialized(size_type count)
+    requires(detail::can_leave_uninitialized_v<A, T>)
+    {
+        if (count > capacity() - size()) core().reallocate_n(core().next_capacity(count - (capacity() - size())));
+        return std::span<T>(storage_.last(), count);
+    }
 
-    constexpr void resize(size_type count) { resize_impl(count); }
-    constexpr void resize(size_type count, const T& value) { resize_impl(count, value); }
+    // Add the first count elements of the storage returned by append_uninitialized() to the end of the vector.
+    constexpr void commit(size_type count) noexcept
+    requires(detail::can_leave_uninitialized_v<A, T>)
+    {
+        assert(count <= capacity() - size());
+        storage_.set_last(storage_.last() + count);
+    }
 
     constexpr iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
     constexpr iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
@@ -810,95 +2919,102 @@ public:
     template<typename... Args>
     constexpr iterator emplace(const_iterator pos, Args&&... args)
     {
-        if (last_ != last_alloc_)
-        {
-            if (pos == cend()) return std::addressof(emplace_back_unchecked(std::forward<Args>(args)...));
-
-            detail::allocator_managed<T, A> new_elem(alloc_, std::forward<Args>(args)...);
-
-            const difference_type offset = std::distance(cbegin(), pos);
-
-            detail::construct(alloc_, last_, std::move(back()));
-            std::shift_right(first_ + offset, last_++, 1);
-            *(first_ + offset) = std::move(*new_elem);
-            return first_ + offset;
-        }
-
-        return reallocate_emplace(next_capacity(), pos, std::forward<Args>(args)...);
+        return core().emplace(pos, std::forward<Args>(args)...);
     }
 
     constexpr iterator insert(const_iterator pos, size_type count, const T& value)
     {
-        if (last_alloc_ - last_ >= count)
-        {
-            const difference_type offset = std::distance(cbegin(), pos);
-            const difference_type src_size = difference_type(count);
+        return core().insert(pos, count, value);
+    }
 
-            const auto middle = first_ + std::max(ssize() - src_size, offset);
-            const auto moved_size = last_ - middle;
-            const auto old_last   = last_;
-            const auto new_last   = last_ + src_size;
-            const auto new_middle = middle + src_size;
+    template<std::forward_iterator Iter>
+    constexpr iterator insert(const_iterator pos, Iter src_first, Iter src_last)
+    {
+        return core().insert_n(pos, src_first, std::distance(src_first, src_last));
+    }
 
-            detail::construct_range(alloc_, last_, new_middle, value);
-            last_ = new_middle;
-            detail::relocate_range_weak(alloc_, middle, old_last, new_middle);
-            last_ = new_last;
-            detail::assign_range(middle, old_last, value);
+    template<std::input_iterator Iter>
+    constexpr iterator insert(const_iterator pos, Iter src_first, Iter src_last)
+    {
+        return core().insert_input(pos, std::move(src_first), std::move(src_last));
+    }
 
-            return first_ + offset;
+    template<detail::container_compatible_range<T> R>
+    constexpr iterator insert_range(const_iterator pos, R&& range)
+    {
+        if constexpr (std::ranges::forward_range<R>)
+        {
+            return core().insert_n(pos, std::ranges::begin(range), difference_type(std::ranges::distance(range)));
+        }
+        else if constexpr (std::ranges::sized_range<R>)
+        {
+            const auto offset = std::distance(cbegin(), pos);
+            reserve(size() + size_type(std::ranges::size(range)));
+            return core().insert_input(cbegin() + offset, std::ranges::begin(range), std::ranges::end(range));
+        }
+        else
+        {
+            return core().insert_input(pos, std::ranges::begin(range), std::ranges::end(range));
         }
-
-        return reallocate_insert(next_capacity(count), pos, count, value);
     }
 
-    template<std::forward_iterator Iter>
-    constexpr iterator insert(const_iterator pos, Iter src_first, Iter src_last)
+    template<detail::container_compatible_range<T> R>
+    constexpr void append_range(R&& range)
     {
-        const difference_type src_size = std::distance(src_first, src_last);
+        insert_range(cend(), std::forward<R>(range));
+    }
 
-        if (last_alloc_ - last_ >= src_size)
-        {
-            const difference_type offset = std::distance(cbegin(), pos);
+    // The shrink policy may reallocate the vector after the elements are erased, which invalidates all iterators
+    // and references to its elements. Only the returned iterator can be used after the call in that case.
+    constexpr iterator erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        return core().erase(first, last);
+    }
 
-            const auto middle = first_ + std::max(ssize() - src_size, offset);
-            const auto moved_size = last_ - middle;
-            const auto old_last   = last_;
-            const auto new_last   = last_ + src_size;
-            const auto new_middle = middle + src_size;
+    // Erase the element at pos by moving the last element of the vector into its place. This doesn't preserve
+    // the order of the elements, but only moves a single element. Like erase(), it invalidates every iterator
+    // except the returned one if the shrink policy reallocates the vector.
+    constexpr iterator erase_unordered(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        assert(pos != cend());
 
-            detail::construct_range(alloc_, last_, new_middle, std::next(src_first, moved_size));
-            last_ = new_middle;
-            detail::relocate_range_weak(alloc_, middle, old_last, new_middle);
-            last_ = new_last;
-            detail::assign_range(middle, old_last, src_first);
+        const auto offset = std::distance(cbegin(), pos);
+        const pointer elem = storage_.first() + offset;
+        const pointer last = storage_.last() - 1;
 
-            return first_ + offset;
+        if (detail::memcpy_relocatable_v<A, T> && !std::is_constant_evaluated() && elem != last)
+        {
+            // Swap the object representations of the erased and the last elements instead of move assigning,
+            // and destroy the erased element at the end of the vector
+            alignas(T) unsigned char erased[sizeof(T)];
+            std::memcpy(erased, (void*)elem, sizeof(T));
+            std::memcpy((void*)elem, (void*)last, sizeof(T));
+            std::memcpy((void*)last, erased, sizeof(T));
+            pop_back();
+        }
+        else
+        {
+            if (elem != last) *elem = std::move(*last);
+            pop_back();
         }
 
-        return reallocate_insert(next_capacity(size_type(src_size)), pos, src_first, src_last);
+        return storage_.first() + offset;
     }
 
-    template<std::input_iterator Iter>
-    constexpr iterator insert(const_iterator pos, Iter src_first, Iter src_last)
+    // Erase all of the elements that satisfy pred, and return the number of erased elements.
+    // The vector may be reallocated by the shrink policy afterwards, invalidating all iterators and references.
+    template<typename Pred>
+    constexpr size_type erase_if(Pred pred)
     {
-        const auto offset = std::distance(cbegin(), pos);
-        const auto old_size = std::distance(first_, last_);
+        const pointer new_last = detail::remove_if(storage_.first(), storage_.last(), pred);
+        const auto erase_count = size_type(storage_.last() - new_last);
 
-        while (src_first != src_last) emplace_back(*src_first++);
-        std::rotate(first_ + offset, first_ + old_size, last_);
+        detail::destroy_range(alloc_, new_last, storage_.last());
+        storage_.set_last(new_last);
 
-        return first_ + offset;
-    }
+        if (erase_count) core().shrink_if_sparse();
 
-    constexpr iterator erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>)
-    {
-        const auto erase_first = first_ + std::distance(cbegin(), first);
-        const auto erase_count = std::distance(first, last);
-        const auto new_last = std::shift_left(erase_first, last_, erase_count);
-        detail::destroy_range(alloc_, new_last, last_);
-        last_ = new_last;
-        return erase_first;
+        return erase_count;
     }
 
     //-----------------------------------//
@@ -909,197 +3025,356 @@ public:
 
     constexpr friend bool operator==(const small_vector& lhs, const small_vector& rhs) noexcept
     {
+        if constexpr (detail::is_memcmp_equality_comparable_v<T>)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                return lhs.size() == rhs.size() && (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0);
+            }
+        }
         return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
     constexpr friend auto operator<=>(const small_vector& lhs, const small_vector& rhs) noexcept
     {
+        if constexpr (detail::is_memcmp_orderable_v<T> || std::is_integral_v<T>)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                const size_type common_size = std::min(lhs.size(), rhs.size());
+
+                if constexpr (detail::is_memcmp_orderable_v<T>)
+                {
+                    const int result = common_size ? std::memcmp(lhs.data(), rhs.data(), common_size * sizeof(T)) : 0;
+                    if (result != 0) return result <=> 0;
+                }
+                else
+                {
+                    const std::size_t pos = detail::mismatch(lhs.data(), rhs.data(), common_size);
+                    if (pos != common_size) return lhs[pos] <=> rhs[pos];
+                }
+                return lhs.size() <=> rhs.size();
+            }
+        }
         return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
 private:
-    static constexpr std::size_t alignment = std::max(alignof(T), detail::cache_line_size);
+    using storage_type = typename Options::layout::template storage_type<pointer>;
+
+    using stats_recorder = std::conditional_t<std::is_same_v<typename Options::stats, no_stats>,
+        detail::no_stats_recorder, detail::static_stats_recorder<typename Options::stats, small_vector>>;
+
+    using core_type = detail::small_vector_core<T, A, Options, stats_recorder>;
+
+    static constexpr std::size_t alignment = std::max(alignof(T), Options::alignment::min_alignment);
+    static constexpr std::size_t buffer_capacity = Options::alignment::fill_padding ?
+        std::min(detail::padded_buffer_capacity<T, Size>(alignof(storage_type)), storage_type::max_size()) : Size;
+
+    static_assert(Size <= storage_type::max_size(), "The size of the inline buffer exceeds the maximum size of the layout.");
+
+    // Small enough inline buffers of trivially relocatable (or copyable) types are moved (or copied) as a whole,
+    // which is faster than only copying the used part of the buffer since the size is known at compile-time.
+    static constexpr bool fixed_size_buffer_relocation = detail::memcpy_relocatable_v<A, T> &&
+        sizeof(detail::small_vector_buffer<T, buffer_capacity>) <= detail::max_fixed_size_copy;
+
+    static constexpr bool fixed_size_buffer_copy = std::is_trivially_copyable_v<T> && detail::has_trivial_construct_v<A&, T, const T&> &&
+        sizeof(detail::small_vector_buffer<T, buffer_capacity>) <= detail::max_fixed_size_copy;
+
+    // Small enough inline buffers are searched using a fixed number of vector comparisons, regardless of the size.
+    static constexpr bool fixed_size_find = detail::is_simd_comparable_v<T> && buffer_capacity && buffer_capacity * sizeof(T) <= detail::max_fixed_size_find;
+
+    template<typename, typename, typename>
+    friend class small_vector_ref;
 
     alignas(alignment)
-    SV_NO_UNIQUE_ADDRESS detail::small_vector_buffer<T, Size> buffer_;
-    pointer first_      = nullptr;
-    pointer last_       = nullptr;
-    pointer last_alloc_ = nullptr;
+    SV_NO_UNIQUE_ADDRESS detail::small_vector_buffer<T, buffer_capacity> buffer_;
+    storage_type storage_;
     SV_NO_UNIQUE_ADDRESS allocator_type alloc_;
 
 
-    constexpr void allocate_n(size_type count)
+    // The operations that don't depend on the Size of the vector are implemented by detail::small_vector_core.
+    constexpr core_type core() noexcept
     {
-        if (count <= inline_capacity()) return set_buffer_storage(0);
-
-        detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, count);
-        first_      = alloc_result.data;
-        last_       = alloc_result.data;
-        last_alloc_ = alloc_result.data + alloc_result.size;
+        return core_type(storage_, alloc_, buffer_.begin(), buffer_capacity);
     }
 
-    constexpr void reallocate_n(size_type new_capacity)
+    // assign src_size elements from a forward range
+    template<std::forward_iterator Iter>
+    constexpr void assign_n(Iter src_first, difference_type src_size)
     {
-        const size_type old_size = size();
+        const auto old_size = ssize();
+        const auto com_size = std::min(old_size, src_size);
 
-        detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_capacity);
-        detail::scope_exit guard{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
-        detail::relocate_range_strong(alloc_, first_, last_, alloc_result.data);
-        detail::destroy_range(alloc_, first_, last_);
-        guard.release();
-        deallocate();
-        set_storage(alloc_result.data, old_size, alloc_result.size);
+        if (difference_type(capacity()) >= src_size)
+        {
+            detail::assign_range(storage_.first(), storage_.first() + com_size, src_first);
+            detail::construct_range(alloc_, storage_.first() + com_size, storage_.first() + src_size, std::next(src_first, com_size));
+            detail::destroy_range(alloc_, storage_.first() + com_size, storage_.last());
+            storage_.set_size(size_type(src_size));
+        }
+        else
+        {
+            size_type new_cap = core().next_capacity(size_type(src_size - old_size));
+            core().record_stats(stats_event::allocate, new_cap);
+            detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_cap, storage_type::max_size());
+            detail::scope_exit guard{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
+            detail::construct_range(alloc_, alloc_result.data, alloc_result.data + src_size, src_first);
+            detail::destroy_range(alloc_, storage_.first(), storage_.last());
+            guard.release();
+            core().deallocate();
+            set_storage(alloc_result.data, size_type(src_size), alloc_result.size);
+        }
     }
 
-    template<typename... Args>
-    constexpr iterator reallocate_append(size_type new_capacity, Args&&... args)
+    constexpr void set_storage(pointer first, size_type size, size_type capacity) noexcept
     {
-        const size_type old_size = size();
-
-        detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_capacity);
-        detail::scope_exit guard1{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
-        detail::construct(alloc_, alloc_result.data + old_size, std::forward<Args>(args)...);
-        detail::scope_exit guard2{ [&] { detail::destroy(alloc_, alloc_result.data + old_size); } };
-        detail::relocate_range_strong(alloc_, first_, last_, alloc_result.data);
-        { guard1.release(); guard2.release(); }
-        detail::destroy_range(alloc_, first_, last_);
-        deallocate();
-        set_storage(alloc_result.data, old_size + 1, alloc_result.size);
-
-        return alloc_result.data + old_size;
+        storage_.set(first, size, capacity);
     }
 
-    template<typename... Args>
-    constexpr iterator reallocate_emplace(size_t new_capacity, const_iterator pos, Args&&... args)
+    constexpr void set_buffer_storage(size_type size) noexcept
     {
-        const size_type old_size = size();
-        const difference_type offset = std::distance(cbegin(), pos);
+        set_storage(buffer_.begin(), size, buffer_capacity);
+    }
+
+}; // class small_vector
+
+template<std::input_iterator Iter, std::size_t Size = detail::default_small_size_v<std::iter_value_t<Iter>>, typename Alloc = std::allocator<std::iter_value_t<Iter>>>
+small_vector(Iter, Iter, Alloc = Alloc()) -> small_vector<std::iter_value_t<Iter>, Size, Alloc>;
+
+#if __cpp_lib_containers_ranges
+template<std::ranges::input_range R, std::size_t Size = detail::default_small_size_v<std::ranges::range_value_t<R>>, typename Alloc = std::allocator<std::ranges::range_value_t<R>>>
+small_vector(std::from_range_t, R&&, Alloc = Alloc()) -> small_vector<std::ranges::range_value_t<R>, Size, Alloc>;
+#endif
+
+template<typename T, std::size_t Size, typename A, typename Options>
+constexpr void swap(small_vector<T, Size, A, Options>& lhs, small_vector<T, Size, A, Options>& rhs)
+noexcept(noexcept(lhs.swap(rhs)))
+{
+    lhs.swap(rhs);
+}
+
+template<typename T, std::size_t Size, typename A, typename Options, typename U>
+constexpr typename small_vector<T, Size, A, Options>::size_type erase(small_vector<T, Size, A, Options>& vec, const U& value)
+{
+    return vec.erase_if([&](const auto& elem) { return elem == value; });
+}
+
+template<typename T, std::size_t Size, typename A, typename Options, typename Pred>
+constexpr typename small_vector<T, Size, A, Options>::size_type erase_if(small_vector<T, Size, A, Options>& vec, Pred pred)
+{
+    return vec.erase_if(std::move(pred));
+}
+
+template<typename T, std::size_t Size = detail::default_small_size_v<T>, typename A = std::allocator<T>>
+using compact_small_vector = small_vector<T, Size, A, compact_small_vector_options>;
+
+//------------------------------------------- SMALL VECTOR REF --------------------------------------------------------
+
+// A non-owning reference to a small_vector<T, Size, A, Options> of any Size, which can be used to modify the referenced
+// vector, similar to llvm::SmallVectorImpl. Functions taking a small_vector_ref only have to be instantiated once for every
+// element type, instead of once for every inline capacity. The location and capacity of the inline buffer of the vector
+// are stored in the reference, and the modifiers use the same small_vector_core implementation as small_vector.
+// The reference is invalidated when the referenced vector is moved or destroyed.
+template<typename T, typename A = std::allocator<T>, typename Options = small_vector_options>
+class small_vector_ref
+{
+public:
+    using value_type      = T;
+    using allocator_type  = A;
+    using reference       = T&;
+    using const_reference = const T&;
+    using pointer         = typename std::allocator_traits<A>::pointer;
+    using const_pointer   = typename std::allocator_traits<A>::const_pointer;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using iterator               = T*;
+    using const_iterator         = const T*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    //-----------------------------------//
+    //            CONSTRUCTORS           //
+    //-----------------------------------//
+
+    template<std::size_t Size>
+    constexpr small_vector_ref(small_vector<T, Size, A, Options>& vec) noexcept :
+        core_(vec.storage_, vec.alloc_, vec.buffer_.begin(), vec.inline_capacity(), make_recorder<small_vector<T, Size, A, Options>>())
+    {}
+
+    //-----------------------------------//
+    //             ITERATORS             //
+    //-----------------------------------//
+
+    constexpr iterator begin() const noexcept { return core_.storage().first(); }
+    constexpr const_iterator cbegin() const noexcept { return core_.storage().first(); }
+
+    constexpr iterator end() const noexcept { return core_.storage().last(); }
+    constexpr const_iterator cend() const noexcept { return core_.storage().last(); }
+
+    constexpr reverse_iterator rbegin() const noexcept { return std::make_reverse_iterator(end()); }
+    constexpr reverse_iterator rend() const noexcept { return std::make_reverse_iterator(begin()); }
 
-        detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_capacity);
-        detail::scope_exit guard1{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
-        detail::construct(alloc_, alloc_result.data + offset, std::forward<Args>(args)...);
-        detail::scope_exit guard2{ [&] { detail::destroy(alloc_, alloc_result.data + offset); } };
-        detail::relocate_range_strong(alloc_, first_, first_ + offset, alloc_result.data);
-        detail::scope_exit guard3{ [&] { detail::destroy_range(alloc_, alloc_result.data, alloc_result.data + offset); } };
-        detail::relocate_range_strong(alloc_, first_ + offset, last_, alloc_result.data + offset + 1);
-        { guard1.release(); guard2.release(); guard3.release(); }
-        detail::destroy_range(alloc_, first_, last_);
-        deallocate();
-        set_storage(alloc_result.data, old_size + 1, alloc_result.size);
+    //-----------------------------------//
+    //           ELEMENT ACCESS          //
+    //-----------------------------------//
 
-        return alloc_result.data + offset;
+    constexpr reference operator[](size_type pos) const noexcept
+    {
+        assert(pos < size());
+        return begin()[pos];
     }
 
-    constexpr iterator reallocate_insert(size_t new_capacity, const_iterator pos, size_type count, const T& value)
+    constexpr reference at(size_type pos) const
     {
-        const size_type old_size = size();
-        const difference_type src_size = difference_type(count);
-        const difference_type offset = std::distance(cbegin(), pos);
+        if (pos >= size()) throw std::out_of_range{ "Bad vector index." };
+        return begin()[pos];
+    }
 
-        detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_capacity);
-        detail::scope_exit guard1{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
-        detail::relocate_range_weak(alloc_, first_, first_ + offset, alloc_result.data);
-        detail::scope_exit guard2{ [&] { detail::destroy_range(alloc_, alloc_result.data, alloc_result.data + offset); } };
-        detail::construct_range(alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size, value);
-        detail::scope_exit guard3{ [&] { detail::destroy_range(alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size); } };
-        detail::relocate_range_weak(alloc_, first_ + offset, last_, alloc_result.data + offset + src_size);
-        { guard1.release(); guard2.release(); guard3.release(); }
-        detail::destroy_range(alloc_, first_, last_);
-        deallocate();
-        set_storage(alloc_result.data, old_size + count, alloc_result.size);
+    constexpr reference front() const noexcept { assert(!empty()); return *begin(); }
+    constexpr reference back() const noexcept { assert(!empty()); return *(end() - 1); }
 
-        return alloc_result.data + offset;
-    }
+    constexpr pointer data() const noexcept { return begin(); }
 
-    template<std::forward_iterator Iter>
-    constexpr iterator reallocate_insert(size_t new_capacity, const_iterator pos, Iter src_first, Iter src_last)
+    //-----------------------------------//
+    //              CAPACITY             //
+    //-----------------------------------//
+
+    constexpr bool empty() const noexcept { return core_.size() == 0; }
+
+    constexpr size_type size() const noexcept { return core_.size(); }
+    constexpr difference_type ssize() const noexcept { return core_.ssize(); }
+    constexpr size_type capacity() const noexcept { return core_.capacity(); }
+    constexpr size_type max_size() const noexcept { return core_.max_size(); }
+
+    constexpr bool is_small() const noexcept { return core_.is_small(); }
+    constexpr size_type inline_capacity() const noexcept { return core_.inline_capacity(); }
+
+    constexpr void reserve(size_type new_capacity) const { core_.reserve(new_capacity); }
+
+    //-----------------------------------//
+    //             MODIFIERS             //
+    //-----------------------------------//
+
+    constexpr void clear() const noexcept
     {
-        const size_type old_size = size();
-        const difference_type src_size = std::distance(src_first, src_last);
-        const difference_type offset = std::distance(cbegin(), pos);
+        detail::destroy_range(core_.allocator(), begin(), end());
+        core_.storage().set_size(0);
+    }
 
-        detail::alloc_result_t<A> alloc_result = detail::allocate<T>(alloc_, new_capacity);
-        detail::scope_exit guard1{ [&] { detail::deallocate(alloc_, alloc_result.data, alloc_result.size); } };
-        detail::relocate_range_weak(alloc_, first_, first_ + offset, alloc_result.data);
-        detail::scope_exit guard2{ [&] { detail::destroy_range(alloc_, alloc_result.data, alloc_result.data + offset); } };
-        detail::construct_range(alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size, src_first);
-        detail::scope_exit guard3{ [&] { detail::destroy_range(alloc_, alloc_result.data + offset, alloc_result.data + offset + src_size); } };
-        detail::relocate_range_weak(alloc_, first_ + offset, last_, alloc_result.data + offset + src_size);
-        { guard1.release(); guard2.release(); guard3.release(); }
-        detail::destroy_range(alloc_, first_, last_);
-        deallocate();
-        set_storage(alloc_result.data, old_size + size_type(src_size), alloc_result.size);
+    constexpr void push_back(const T& value) const { emplace_back(value); }
+    constexpr void push_back(T&& value) const { emplace_back(std::move(value)); }
 
-        return alloc_result.data + offset;
+    template<typename... Args>
+    constexpr reference emplace_back(Args&&... args) const
+    {
+        return core_.emplace_back(std::forward<Args>(args)...);
     }
 
-    constexpr void deallocate() noexcept
+    // The shrink policy of the referenced vector applies, so these may reallocate it and invalidate its iterators.
+    constexpr void pop_back() const noexcept
     {
-        if (!is_small() && data()) detail::deallocate(alloc_, first_, capacity());
+        assert(!empty());
+        core_.pop_back();
     }
 
+    constexpr void resize(size_type count) const { core_.resize(count); }
+    constexpr void resize(size_type count, const T& value) const { core_.resize(count, value); }
+
+    constexpr iterator insert(const_iterator pos, const T& value) const { return emplace(pos, value); }
+    constexpr iterator insert(const_iterator pos, T&& value) const { return emplace(pos, std::move(value)); }
+    constexpr iterator insert(const_iterator pos, size_type count, const T& value) const { return core_.insert(pos, count, value); }
+    constexpr iterator insert(const_iterator pos, std::initializer_list<T> list) const { return insert(pos, list.begin(), list.end()); }
+
     template<typename... Args>
-    constexpr void resize_impl(size_type count, Args&&... args)
+    constexpr iterator emplace(const_iterator pos, Args&&... args) const
     {
-        if (count <= size())
-        {
-            detail::destroy_range(alloc_, first_ + count, last_);
-            last_ = first_ + count;
-        }
-        else
-        {
-            reserve(count);
-            detail::construct_range(alloc_, last_, first_ + count, std::forward<Args>(args)...);
-            last_ = first_ + count;
-        }
+        return core_.emplace(pos, std::forward<Args>(args)...);
     }
 
-    constexpr void set_storage(pointer first, pointer last, pointer last_alloc) noexcept
+    template<std::forward_iterator Iter>
+    constexpr iterator insert(const_iterator pos, Iter src_first, Iter src_last) const
     {
-        first_ = first;
-        last_ = last;
-        last_alloc_ = last_alloc;
+        return core_.insert_n(pos, src_first, std::distance(src_first, src_last));
     }
 
-    constexpr void set_storage(pointer first, size_type size, size_type capacity) noexcept
+    template<std::input_iterator Iter>
+    constexpr iterator insert(const_iterator pos, Iter src_first, Iter src_last) const
     {
-        set_storage(first, first + size, first + capacity);
+        return core_.insert_input(pos, std::move(src_first), std::move(src_last));
     }
 
-    constexpr void set_buffer_storage(size_type size) noexcept
+    // Only the returned iterator is guaranteed to be valid if the shrink policy reallocates the vector.
+    constexpr iterator erase(const_iterator pos) const noexcept(std::is_nothrow_move_assignable_v<T>) { return erase(pos, pos + 1); }
+
+    constexpr iterator erase(const_iterator first, const_iterator last) const noexcept(std::is_nothrow_move_assignable_v<T>)
     {
-        set_storage(buffer_.begin(), buffer_.begin() + size, buffer_.end());
+        return core_.erase(first, last);
     }
 
-    constexpr size_type next_capacity(size_type min_growth = 1) const
+    //-----------------------------------//
+    //               OTHER               //
+    //-----------------------------------//
+
+    constexpr allocator_type get_allocator() const noexcept(std::is_nothrow_copy_constructible_v<A>) { return core_.allocator(); }
+
+    constexpr friend bool operator==(const small_vector_ref& lhs, const small_vector_ref& rhs)
     {
-        const size_type current_capacity = capacity();
-        const size_type growth_capacity  = current_capacity >> 1;
-        const size_type max_capacity     = max_size();
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
 
-        if (min_growth > max_capacity - current_capacity)
-        {
-            throw std::length_error{ "Too big vector." };
-        }
+private:
+    static constexpr bool has_stats = !std::is_same_v<typename Options::stats, no_stats>;
 
-        if (current_capacity > max_capacity - growth_capacity)
-        {
-            return max_capacity;
-        }
+    // The events are reported through a function pointer, so they are attributed to the referenced vector
+    using stats_recorder = std::conditional_t<has_stats, detail::dynamic_stats_recorder, detail::no_stats_recorder>;
 
-        return std::max(current_capacity + min_growth, current_capacity + growth_capacity);
+    detail::small_vector_core<T, A, Options, stats_recorder> core_;
+
+
+    template<typename Vector>
+    static constexpr stats_recorder make_recorder() noexcept
+    {
+        if constexpr (has_stats) return stats_recorder{ &Options::stats::template record<Vector> };
+        else return stats_recorder{};
     }
 
-}; // class small_vector
+}; // class small_vector_ref
 
-template<std::input_iterator Iter, std::size_t Size = detail::default_small_size_v<std::iter_value_t<Iter>>, typename Alloc = std::allocator<std::iter_value_t<Iter>>>
-small_vector(Iter, Iter, Alloc = Alloc()) -> small_vector<std::iter_value_t<Iter>, Size, Alloc>;
+template<typename T, std::size_t Size, typename A, typename Options>
+small_vector_ref(small_vector<T, Size, A, Options>&) -> small_vector_ref<T, A, Options>;
 
-template<typename T, std::size_t Size, typename A>
-constexpr void swap(small_vector<T, Size, A>& lhs, small_vector<T, Size, A>& rhs)
-noexcept(noexcept(lhs.swap(rhs)))
+namespace std
 {
-    lhs.swap(rhs);
-}
+    template<typename T, std::size_t Size, typename A, typename Options>
+    requires(detail::is_bytewise_hashable_v<T> || detail::std_hashable<T>)
+    struct hash<small_vector<T, Size, A, Options>>
+    {
+        // The hash only depends on the elements of the vector, so it's the same for every Size and Options,
+        // and for both inline and dynamically allocated storage.
+        std::size_t operator()(const small_vector<T, Size, A, Options>& vec) const noexcept(noexcept(detail::hash_range(vec.data(), vec.data())))
+        {
+            return detail::hash_range(vec.data(), vec.data() + vec.size());
+        }
+    };
+
+} // namespace std
+
+namespace small_vector_pmr
+{
+    template<typename T, std::size_t Size = detail::default_small_size_v<T>, typename Options = small_vector_options>
+    using small_vector = ::small_vector<T, Size, std::pmr::polymorphic_allocator<T>, Options>;
+
+    template<typename T, std::size_t Size = detail::default_small_size_v<T>>
+    using compact_small_vector = ::small_vector<T, Size, std::pmr::polymorphic_allocator<T>, compact_small_vector_options>;
+
+} // namespace small_vector_pmr
+
+// The extern template declarations of the specializations compiled into the small_vector_instantiations library,
+// defined by the library for the targets linking against it.
+#ifdef SV_EXTERN_TEMPLATES
+#   include <small_vector_instantiations.hpp>
+#endif
 
 #endif // !SMALL_VECTOR_SMALL_VECTOR_HPP
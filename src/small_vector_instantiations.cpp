@@ -0,0 +1,11 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// The explicit instantiation definitions matching the extern template declarations of the generated
+// small_vector_instantiations.hpp header. The element types must be copyable, since every member function
+// of the specializations without a constraint is instantiated.
+
+#include <small_vector_instantiations.hpp>
+
+#define SV_INSTANTIATE_TEMPLATE(...) template class __VA_ARGS__;
+SV_INSTANTIATED_TYPES(SV_INSTANTIATE_TEMPLATE)
+#undef SV_INSTANTIATE_TEMPLATE
@@ -0,0 +1,311 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+#ifndef SMALL_VECTOR_SMALL_VECTOR_SERIALIZATION_HPP
+#define SMALL_VECTOR_SMALL_VECTOR_SERIALIZATION_HPP
+
+#include "small_vector.hpp"
+#include <istream>
+#include <ostream>
+#include <span>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <bit>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <stdexcept>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+// The binary format of a serialized vector is a 16 byte header, followed by the elements of the vector and padding:
+//
+//  - the number of elements of the vector, as a 64 bit little-endian integer,
+//  - the size of an element in bytes, as a 64 bit little-endian integer,
+//  - the object representations of the elements, padded with zero bytes to a multiple of serialization_alignment bytes.
+//
+// Arithmetic and enum elements are stored in little-endian byte order, so they can be read on a host with a different
+// endianness. Other element types are stored as they are in memory, so they can only be read on hosts with the same
+// layout for the type. On little-endian hosts, the elements are written and read using a single memcpy, and a
+// serialized vector can be used in place through serialized_view() (e.g. from a memory mapped file).
+// The serialized vectors can be concatenated, the padding keeps every header and element range aligned to
+// serialization_alignment bytes as long as the start of the whole buffer is.
+
+inline constexpr std::size_t serialization_header_size = 16;
+inline constexpr std::size_t serialization_alignment = 8;
+
+template<typename T>
+concept serializable_element = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !std::is_member_pointer_v<T>;
+
+namespace detail
+{
+    // True if the elements must be byte swapped between their in-memory and serialized representations on this host.
+    template<typename T>
+    inline constexpr bool serialization_needs_byteswap_v =
+        std::endian::native != std::endian::little && (std::is_arithmetic_v<T> || std::is_enum_v<T>) && sizeof(T) > 1;
+
+    inline void byteswap_elements(std::byte* first, std::size_t count, std::size_t element_size) noexcept
+    {
+        for (std::size_t i = 0; i < count; i++, first += element_size)
+        {
+            for (std::size_t lo = 0, hi = element_size - 1; lo < hi; lo++, hi--) std::swap(first[lo], first[hi]);
+        }
+    }
+
+    inline void store_le64(std::byte* dest, std::uint64_t value) noexcept
+    {
+        if constexpr (std::endian::native != std::endian::little) detail::byteswap_elements(reinterpret_cast<std::byte*>(&value), 1, 8);
+        std::memcpy(dest, &value, 8);
+    }
+
+    inline std::uint64_t load_le64(const std::byte* src) noexcept
+    {
+        std::uint64_t value;
+        std::memcpy(&value, src, 8);
+        if constexpr (std::endian::native != std::endian::little) detail::byteswap_elements(reinterpret_cast<std::byte*>(&value), 1, 8);
+        return value;
+    }
+
+    constexpr std::size_t serialization_padding(std::size_t payload_size) noexcept
+    {
+        return (serialization_alignment - payload_size % serialization_alignment) % serialization_alignment;
+    }
+
+    template<typename T>
+    void write_serialization_header(std::byte* dest, std::size_t count) noexcept
+    {
+        detail::store_le64(dest, count);
+        detail::store_le64(dest + 8, sizeof(T));
+    }
+
+    // Validate the header of a serialized vector of T, and return the number of elements in it.
+    template<typename T>
+    std::size_t parse_serialization_header(const std::byte* header)
+    {
+        const std::uint64_t count = detail::load_le64(header);
+        const std::uint64_t element_size = detail::load_le64(header + 8);
+
+        if (element_size != sizeof(T))
+        {
+            throw std::runtime_error("The element size of the serialized vector doesn't match the size of the element type.");
+        }
+        if (count > (std::numeric_limits<std::size_t>::max() - serialization_header_size - serialization_alignment) / sizeof(T))
+        {
+            throw std::runtime_error("Invalid serialized vector size.");
+        }
+        return std::size_t(count);
+    }
+
+    template<typename T>
+    void write_elements(std::byte* dest, const T* first, std::size_t count) noexcept
+    {
+        std::memcpy(dest, first, count * sizeof(T));
+        if constexpr (serialization_needs_byteswap_v<T>) detail::byteswap_elements(dest, count, sizeof(T));
+    }
+
+    template<typename T>
+    void read_elements(T* dest, const std::byte* first, std::size_t count) noexcept
+    {
+        std::memcpy(dest, first, count * sizeof(T));
+        if constexpr (serialization_needs_byteswap_v<T>) detail::byteswap_elements(reinterpret_cast<std::byte*>(dest), count, sizeof(T));
+    }
+
+    // Replace the contents of vec with count elements read by read(T* data, size_t count) -> bool.
+    template<typename T, std::size_t Size, typename A, typename Options, typename Read>
+    bool overwrite_elements(small_vector<T, Size, A, Options>& vec, std::size_t count, Read read)
+    {
+        if constexpr (can_leave_uninitialized_v<A, T>)
+        {
+            bool success = false;
+            vec.clear();
+            vec.resize_and_overwrite(count, [&](T* data, std::size_t n) { success = read(data, n); return success ? n : 0; });
+            return success;
+        }
+        else
+        {
+            vec.resize_default_init(count);
+            if (read(vec.data(), count)) return true;
+            vec.clear();
+            return false;
+        }
+    }
+
+    // The maximum number of bytes read from a stream before the vector is grown again, so an invalid element count
+    // in the header of a serialized vector can't cause an allocation much larger than the data in the stream.
+    inline constexpr std::size_t serialization_stream_chunk_size = 64 * 1024;
+
+    // Append count elements read from the stream to the end of vec, in chunks of serialization_stream_chunk_size bytes.
+    template<typename T, std::size_t Size, typename A, typename Options>
+    bool read_stream_elements(small_vector<T, Size, A, Options>& vec, std::size_t count, std::istream& is)
+    {
+        const std::size_t chunk_count = std::max<std::size_t>(serialization_stream_chunk_size / sizeof(T), 1);
+
+        while (count)
+        {
+            const std::size_t n = std::min(count, chunk_count);
+
+            T* dest = nullptr;
+            if constexpr (can_leave_uninitialized_v<A, T>)
+            {
+                dest = vec.append_uninitialized(n).data();
+            }
+            else
+            {
+                vec.resize_default_init(vec.size() + n);
+                dest = vec.data() + vec.size() - n;
+            }
+
+            if (!is.read(reinterpret_cast<char*>(dest), std::streamsize(n * sizeof(T)))) return false;
+            if constexpr (serialization_needs_byteswap_v<T>) detail::byteswap_elements(reinterpret_cast<std::byte*>(dest), n, sizeof(T));
+            if constexpr (can_leave_uninitialized_v<A, T>) vec.commit(n);
+
+            count -= n;
+        }
+        return true;
+    }
+
+} // namespace detail
+
+// Return the number of bytes written by write_to() for a vector of count elements of type T.
+template<serializable_element T>
+constexpr std::size_t serialized_size(std::size_t count) noexcept
+{
+    return serialization_header_size + count * sizeof(T) + detail::serialization_padding(count * sizeof(T));
+}
+
+template<serializable_element T, std::size_t Size, typename A, typename Options>
+constexpr std::size_t serialized_size(const small_vector<T, Size, A, Options>& vec) noexcept
+{
+    return serialized_size<T>(vec.size());
+}
+
+// Write the vector to the start of buffer, and return the number of bytes written, which is serialized_size(vec).
+// Throws std::length_error if the buffer is too small.
+template<serializable_element T, std::size_t Size, typename A, typename Options>
+std::size_t write_to(const small_vector<T, Size, A, Options>& vec, std::span<std::byte> buffer)
+{
+    const std::size_t payload_size = vec.size() * sizeof(T);
+    const std::size_t total_size = serialized_size(vec);
+
+    if (buffer.size() < total_size) throw std::length_error("The buffer is too small for the serialized vector.");
+
+    detail::write_serialization_header<T>(buffer.data(), vec.size());
+    if (payload_size)
+    {
+        // Zero the padding with a fixed size store before the elements are copied over the start of it
+        std::memset(buffer.data() + total_size - serialization_alignment, 0, serialization_alignment);
+        detail::write_elements(buffer.data() + serialization_header_size, vec.data(), vec.size());
+    }
+
+    return total_size;
+}
+
+// Replace the contents of the vector with the vector serialized at the start of buffer, and return the number of bytes read.
+// Throws std::runtime_error if the buffer doesn't start with a valid serialized vector of T, the vector is left empty in this case.
+template<serializable_element T, std::size_t Size, typename A, typename Options>
+std::size_t read_from(small_vector<T, Size, A, Options>& vec, std::span<const std::byte> buffer)
+{
+    vec.clear();
+
+    if (buffer.size() < serialization_header_size) throw std::runtime_error("The buffer is too small for a serialized vector.");
+
+    const std::size_t count = detail::parse_serialization_header<T>(buffer.data());
+    const std::size_t total_size = serialized_size<T>(count);
+
+    if (buffer.size() < total_size) throw std::runtime_error("The serialized vector is truncated.");
+    if (count > vec.max_size()) throw std::runtime_error("Invalid serialized vector size.");
+
+    detail::overwrite_elements(vec, count, [&](T* data, std::size_t n)
+    {
+        if (n) detail::read_elements(data, buffer.data() + serialization_header_size, n);
+        return true;
+    });
+
+    return total_size;
+}
+
+// Return a view of the elements of the vector serialized at the start of buffer, without copying them. The buffer
+// must stay alive while the view is used. Throws std::runtime_error if the buffer doesn't start with a valid serialized
+// vector of T, or the elements aren't suitably aligned for T in the buffer.
+template<serializable_element T>
+requires(!detail::serialization_needs_byteswap_v<T>)
+std::span<const T> serialized_view(std::span<const std::byte> buffer)
+{
+    if (buffer.size() < serialization_header_size) throw std::runtime_error("The buffer is too small for a serialized vector.");
+
+    const std::size_t count = detail::parse_serialization_header<T>(buffer.data());
+
+    if (buffer.size() < serialized_size<T>(count)) throw std::runtime_error("The serialized vector is truncated.");
+
+    const std::byte* first = buffer.data() + serialization_header_size;
+    if (reinterpret_cast<std::uintptr_t>(first) % alignof(T))
+    {
+        throw std::runtime_error("The serialized vector is not suitably aligned for the element type.");
+    }
+    // The objects of trivially copyable types are implicitly created in the storage that the elements were copied to
+    return std::span<const T>(std::launder(reinterpret_cast<const T*>(first)), count);
+}
+
+// Write the vector to the stream in the same format as write_to(). Sets badbit on the stream if the write fails.
+template<serializable_element T, std::size_t Size, typename A, typename Options>
+std::ostream& write_to(const small_vector<T, Size, A, Options>& vec, std::ostream& os)
+{
+    std::array<std::byte, serialization_header_size> header;
+    detail::write_serialization_header<T>(header.data(), vec.size());
+    os.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()));
+
+    if constexpr (detail::serialization_needs_byteswap_v<T>)
+    {
+        for (const T& elem : vec)
+        {
+            std::array<std::byte, sizeof(T)> bytes;
+            detail::write_elements(bytes.data(), &elem, 1);
+            os.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+        }
+    }
+    else
+    {
+        os.write(reinterpret_cast<const char*>(vec.data()), std::streamsize(vec.size() * sizeof(T)));
+    }
+
+    static constexpr char padding[serialization_alignment] = {};
+    return os.write(padding, std::streamsize(detail::serialization_padding(vec.size() * sizeof(T))));
+}
+
+// Replace the contents of the vector with a vector read from the stream in the format written by write_to().
+// Sets failbit on the stream and leaves the vector empty if the stream doesn't contain a valid serialized vector of T.
+template<serializable_element T, std::size_t Size, typename A, typename Options>
+std::istream& read_from(small_vector<T, Size, A, Options>& vec, std::istream& is)
+{
+    vec.clear();
+
+    std::array<std::byte, serialization_header_size> header;
+    if (!is.read(reinterpret_cast<char*>(header.data()), std::streamsize(header.size()))) return is;
+
+    std::size_t count = 0;
+    try
+    {
+        count = detail::parse_serialization_header<T>(header.data());
+        if (count > vec.max_size()) throw std::runtime_error("Invalid serialized vector size.");
+    }
+    catch (const std::runtime_error&)
+    {
+        is.setstate(std::ios_base::failbit);
+        return is;
+    }
+
+    // The vector is only grown as the elements are read, since the count in the header can't be validated in advance
+    if (detail::read_stream_elements(vec, count, is))
+    {
+        is.ignore(std::streamsize(detail::serialization_padding(count * sizeof(T))));
+    }
+    else
+    {
+        vec.clear();
+    }
+
+    return is;
+}
+
+#endif // !SMALL_VECTOR_SMALL_VECTOR_SERIALIZATION_HPP
@@ -0,0 +1,641 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+#ifndef SMALL_VECTOR_SMALL_VECTOR_STATS_HPP
+#define SMALL_VECTOR_SMALL_VECTOR_STATS_HPP
+
+#include "small_vector.hpp"
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <bit>
+#include <iomanip>
+#include <stdexcept>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+// The allocation statistics collected by counting_stats for a small_vector type or call site.
+struct stats_counters
+{
+    std::uint64_t allocate           = 0;   // The number of stats_event::allocate events.
+    std::uint64_t reallocate         = 0;   // The number of stats_event::reallocate events.
+    std::uint64_t reallocate_append  = 0;   // The number of stats_event::reallocate_append events.
+    std::uint64_t reallocate_emplace = 0;   // The number of stats_event::reallocate_emplace events.
+    std::uint64_t reallocate_insert  = 0;   // The number of stats_event::reallocate_insert events.
+    std::uint64_t deallocate         = 0;   // The number of stats_event::deallocate events.
+    std::uint64_t spills             = 0;   // The number of times a vector moved from its inline buffer to the heap.
+    std::uint64_t allocated_bytes    = 0;   // The total number of bytes requested from the allocator.
+    std::uint64_t relocated_bytes    = 0;   // The total number of bytes of elements moved to a new storage.
+
+    constexpr std::uint64_t allocations() const noexcept
+    {
+        return allocate + reallocate + reallocate_append + reallocate_emplace + reallocate_insert;
+    }
+
+    constexpr stats_counters& operator+=(const stats_counters& rhs) noexcept
+    {
+        allocate           += rhs.allocate;
+        reallocate         += rhs.reallocate;
+        reallocate_append  += rhs.reallocate_append;
+        reallocate_emplace += rhs.reallocate_emplace;
+        reallocate_insert  += rhs.reallocate_insert;
+        deallocate         += rhs.deallocate;
+        spills             += rhs.spills;
+        allocated_bytes    += rhs.allocated_bytes;
+        relocated_bytes    += rhs.relocated_bytes;
+        return *this;
+    }
+
+    friend constexpr bool operator==(const stats_counters&, const stats_counters&) noexcept = default;
+};
+
+namespace detail
+{
+    // The counters of a single thread for a single small_vector type or call site. The counters are only
+    // written by their own thread, so they are updated without atomic read-modify-write operations.
+    class stats_entry
+    {
+    public:
+        explicit stats_entry(std::string name) : name_(std::move(name)) {}
+
+        const std::string& name() const noexcept { return name_; }
+
+        void add(stats_event event, const stats_params& params, std::size_t element_size) noexcept
+        {
+            increment(std::size_t(event), 1);
+
+            if (event == stats_event::deallocate) return;
+
+            increment(spill_index, params.is_small);
+            increment(allocated_bytes_index, params.new_capacity * element_size);
+            increment(relocated_bytes_index, params.relocated_bytes);
+        }
+
+        stats_counters load() const noexcept
+        {
+            auto get = [&](std::size_t idx) { return values_[idx].load(std::memory_order_relaxed); };
+
+            return {
+                get(std::size_t(stats_event::allocate)),
+                get(std::size_t(stats_event::reallocate)),
+                get(std::size_t(stats_event::reallocate_append)),
+                get(std::size_t(stats_event::reallocate_emplace)),
+                get(std::size_t(stats_event::reallocate_insert)),
+                get(std::size_t(stats_event::deallocate)),
+                get(spill_index),
+                get(allocated_bytes_index),
+                get(relocated_bytes_index)
+            };
+        }
+
+        void clear() noexcept
+        {
+            for (auto& value : values_) value.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr std::size_t spill_index           = std::size_t(stats_event::deallocate) + 1;
+        static constexpr std::size_t allocated_bytes_index = spill_index + 1;
+        static constexpr std::size_t relocated_bytes_index = spill_index + 2;
+
+        std::string name_;
+        std::atomic<std::uint64_t> values_[relocated_bytes_index + 1] = {};
+
+        void increment(std::size_t idx, std::uint64_t amount) noexcept
+        {
+            values_[idx].store(values_[idx].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    };
+
+    inline std::string demangle(const char* name)
+    {
+    #if __has_include(<cxxabi.h>)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && demangled)
+        {
+            std::string result(demangled);
+            std::free(demangled);
+            return result;
+        }
+    #endif
+        return name;
+    }
+
+} // namespace detail
+
+
+// The registry of the counters of every thread and every small_vector type or call site using counting_stats.
+// The counters of a thread are kept after the thread exits, so they are included in the results.
+class stats_registry
+{
+public:
+    static stats_registry& instance() noexcept
+    {
+        // never destroyed, so the counters remain valid for vectors destroyed during static destruction
+        static stats_registry* registry = new stats_registry;
+        return *registry;
+    }
+
+    // Add a set of counters for the calling thread. Returns nullptr if the counters couldn't be allocated.
+    detail::stats_entry* add_entry(const std::string& name) noexcept
+    {
+        try
+        {
+            std::scoped_lock lock{ mutex_ };
+            return std::addressof(entries_.emplace_back(name));
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    // The sum of the counters of every thread for each small_vector type or call site, sorted by name.
+    std::vector<std::pair<std::string, stats_counters>> snapshot() const
+    {
+        std::map<std::string, stats_counters> totals;
+        {
+            std::scoped_lock lock{ mutex_ };
+            for (const detail::stats_entry& entry : entries_) totals[entry.name()] += entry.load();
+        }
+        return { totals.begin(), totals.end() };
+    }
+
+    // The sum of the counters of every thread for the given small_vector type or call site.
+    stats_counters get(const std::string& name) const
+    {
+        stats_counters total;
+
+        std::scoped_lock lock{ mutex_ };
+        for (const detail::stats_entry& entry : entries_)
+        {
+            if (entry.name() == name) total += entry.load();
+        }
+        return total;
+    }
+
+    // Write the current statistics to 'os' in a human readable format, one line for each type or call site.
+    void dump(std::ostream& os) const
+    {
+        for (const auto& [name, counters] : snapshot())
+        {
+            os << name << ":"
+               << " spills=" << counters.spills
+               << " allocate=" << counters.allocate
+               << " reallocate=" << counters.reallocate
+               << " reallocate_append=" << counters.reallocate_append
+               << " reallocate_emplace=" << counters.reallocate_emplace
+               << " reallocate_insert=" << counters.reallocate_insert
+               << " deallocate=" << counters.deallocate
+               << " allocated_bytes=" << counters.allocated_bytes
+               << " relocated_bytes=" << counters.relocated_bytes << '\n';
+        }
+    }
+
+    // Set every counter to zero. Events recorded concurrently with the reset by other threads may be lost.
+    void reset() noexcept
+    {
+        std::scoped_lock lock{ mutex_ };
+        for (detail::stats_entry& entry : entries_) entry.clear();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<detail::stats_entry> entries_;
+};
+
+
+// A statistics policy that counts the allocation events of the vectors in thread-local counters, which can be
+// read using stats_registry. The counters are aggregated per vector type if Tag is void, otherwise per Tag,
+// which can be used to tell call sites apart. If Tag has a static 'name' member, it is used as the name
+// of the counters instead of the name of the type.
+template<typename Tag = void>
+struct counting_stats
+{
+    template<typename Vector>
+    static std::string name()
+    {
+        if constexpr (requires { { Tag::name } -> std::convertible_to<std::string>; }) return Tag::name;
+        else if constexpr (std::is_void_v<Tag>) return detail::demangle(typeid(Vector).name());
+        else return detail::demangle(typeid(Tag).name());
+    }
+
+    template<typename Vector>
+    static void record(stats_event event, const stats_params& params) noexcept
+    {
+        if (event == stats_event::move || event == stats_event::destroy) return;
+
+        thread_local detail::stats_entry* const entry = register_entry<Vector>();
+
+        if (entry) [[likely]] entry->add(event, params, sizeof(typename Vector::value_type));
+    }
+
+private:
+    template<typename Vector>
+    static detail::stats_entry* register_entry() noexcept
+    {
+        try { return stats_registry::instance().add_entry(name<Vector>()); }
+        catch (...) { return nullptr; }
+    }
+};
+
+//---------------------------------------------- SIZE PROFILES -------------------------------------------------------
+
+// The distribution of the sizes of the vectors of a small_vector type or call site at the time of their destruction.
+// Sizes below exact_sizes are counted individually, larger sizes are counted in power of 2 ranges. The histogram
+// doesn't reflect the sizes the vectors had before they were shrunk or cleared, only peak_capacity does.
+struct size_profile
+{
+    static constexpr std::size_t exact_sizes = 256;
+    static constexpr std::size_t bucket_count = exact_sizes + std::numeric_limits<std::size_t>::digits - std::bit_width(exact_sizes - 1);
+
+    std::string name;
+    std::size_t element_size = 0;       // The size of the elements of the vectors in bytes.
+    std::size_t inline_capacity = 0;    // The current inline capacity of the vectors.
+    std::size_t peak_capacity = 0;      // The largest capacity reached by any of the vectors, including the ones that weren't sampled.
+    std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(bucket_count);
+
+    static constexpr std::size_t bucket_of(std::size_t size) noexcept
+    {
+        if (size < exact_sizes) return size;
+        return exact_sizes + std::size_t(std::bit_width(size)) - std::size_t(std::bit_width(exact_sizes));
+    }
+
+    // The smallest size counted in the bucket.
+    static constexpr std::size_t bucket_min(std::size_t bucket) noexcept
+    {
+        if (bucket < exact_sizes) return bucket;
+        return exact_sizes << (bucket - exact_sizes);
+    }
+
+    std::uint64_t samples() const noexcept
+    {
+        std::uint64_t total = 0;
+        for (std::uint64_t count : counts) total += count;
+        return total;
+    }
+
+    // The fraction of the sampled vectors whose elements wouldn't fit in an inline buffer of the given capacity.
+    double spill_rate(std::size_t capacity) const noexcept
+    {
+        const std::uint64_t total = samples();
+        if (total == 0) return 0.0;
+
+        std::uint64_t spills = 0;
+        for (std::size_t bucket = 0; bucket < counts.size(); bucket++)
+        {
+            if (bucket_min(bucket) > capacity) spills += counts[bucket];
+        }
+        return double(spills) / double(total);
+    }
+
+    size_profile& operator+=(const size_profile& rhs)
+    {
+        peak_capacity = std::max(peak_capacity, rhs.peak_capacity);
+        for (std::size_t bucket = 0; bucket < counts.size(); bucket++) counts[bucket] += rhs.counts[bucket];
+        return *this;
+    }
+};
+
+// Recommend an inline capacity for the vectors described by the profile, which minimizes the expected memory footprint
+// of a vector plus 'spill_cost' bytes for every heap allocation. The spill cost expresses the cost of an allocation and
+// the indirection to the heap in bytes, a higher cost results in larger inline buffers.
+// Only inline capacities in the range [1, size_profile::exact_sizes) are considered.
+inline std::size_t recommend_small_size(const size_profile& profile, double spill_cost = 64.0) noexcept
+{
+    const std::uint64_t total = profile.samples();
+    if (total == 0) return std::max<std::size_t>(profile.inline_capacity, 1);
+
+    const double element_size = double(std::max<std::size_t>(profile.element_size, 1));
+
+    // the heap cost of the vectors larger than the candidate size, starting from all vectors with at least 1 element
+    double spilled_count = 0.0;
+    double spilled_bytes = 0.0;
+
+    for (std::size_t bucket = 1; bucket < profile.counts.size(); bucket++)
+    {
+        const std::size_t min_size = size_profile::bucket_min(bucket);
+        const double mean_size = bucket < size_profile::exact_sizes ? double(min_size) : 1.5 * double(min_size);
+
+        spilled_count += double(profile.counts[bucket]);
+        spilled_bytes += double(profile.counts[bucket]) * mean_size * element_size;
+    }
+
+    std::size_t best_size = 1;
+    double best_cost = std::numeric_limits<double>::infinity();
+
+    for (std::size_t size = 1; size < size_profile::exact_sizes; size++)
+    {
+        spilled_count -= double(profile.counts[size]);
+        spilled_bytes -= double(profile.counts[size]) * double(size) * element_size;
+
+        const double cost = double(size) * element_size + (spilled_count * spill_cost + spilled_bytes) / double(total);
+
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best_size = size;
+        }
+    }
+
+    return best_size;
+}
+
+// Write the profiles to 'os' in a line based text format. Every profile is described by a line of the form
+// "profile <name> <element_size> <inline_capacity> <peak_capacity>", followed by a line containing the
+// non-empty buckets of its histogram as "histogram <min_size>:<count>...".
+inline void write_size_profiles(std::ostream& os, const std::vector<size_profile>& profiles)
+{
+    os << "# small_vector size profile v1\n";
+    for (const size_profile& profile : profiles)
+    {
+        os << "profile " << std::quoted(profile.name) << ' ' << profile.element_size << ' '
+           << profile.inline_capacity << ' ' << profile.peak_capacity << "\nhistogram";
+
+        for (std::size_t bucket = 0; bucket < profile.counts.size(); bucket++)
+        {
+            if (profile.counts[bucket]) os << ' ' << size_profile::bucket_min(bucket) << ':' << profile.counts[bucket];
+        }
+        os << '\n';
+    }
+}
+
+// Read the profiles written by write_size_profiles(). Throws std::runtime_error if the input is malformed.
+inline std::vector<size_profile> read_size_profiles(std::istream& is)
+{
+    std::vector<size_profile> profiles;
+    std::string line;
+
+    while (std::getline(is, line))
+    {
+        std::istringstream fields(line);
+        std::string kind;
+        if (!(fields >> kind) || kind.front() == '#') continue;
+
+        if (kind == "profile")
+        {
+            size_profile& profile = profiles.emplace_back();
+            if (!(fields >> std::quoted(profile.name) >> profile.element_size >> profile.inline_capacity >> profile.peak_capacity))
+            {
+                throw std::runtime_error("Invalid size profile line: " + line);
+            }
+        }
+        else if (kind == "histogram" && !profiles.empty())
+        {
+            std::size_t size;
+            std::uint64_t count;
+            char separator;
+            while (fields >> size >> separator >> count)
+            {
+                if (separator != ':') throw std::runtime_error("Invalid size profile histogram: " + line);
+                profiles.back().counts[size_profile::bucket_of(size)] += count;
+            }
+        }
+        else
+        {
+            throw std::runtime_error("Invalid size profile line: " + line);
+        }
+    }
+    return profiles;
+}
+
+namespace detail
+{
+    // The size histogram of a single thread for a single small_vector type or call site.
+    class size_profile_entry
+    {
+    public:
+        size_profile_entry(std::string name, std::size_t element_size, std::size_t inline_capacity) :
+            name_(std::move(name)), element_size_(element_size), inline_capacity_(inline_capacity)
+        {}
+
+        void add(std::size_t size, std::size_t capacity) noexcept
+        {
+            std::atomic<std::uint64_t>& count = counts_[size_profile::bucket_of(size)];
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            add_capacity(capacity);
+        }
+
+        void add_capacity(std::size_t capacity) noexcept
+        {
+            if (capacity > peak_capacity_.load(std::memory_order_relaxed)) peak_capacity_.store(capacity, std::memory_order_relaxed);
+        }
+
+        size_profile load() const
+        {
+            size_profile profile{ name_, element_size_, inline_capacity_, peak_capacity_.load(std::memory_order_relaxed) };
+            for (std::size_t bucket = 0; bucket < size_profile::bucket_count; bucket++)
+            {
+                profile.counts[bucket] = counts_[bucket].load(std::memory_order_relaxed);
+            }
+            return profile;
+        }
+
+        void clear() noexcept
+        {
+            for (auto& count : counts_) count.store(0, std::memory_order_relaxed);
+            peak_capacity_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::string name_;
+        std::size_t element_size_;
+        std::size_t inline_capacity_;
+        std::atomic<std::size_t> peak_capacity_ = 0;
+        std::atomic<std::uint64_t> counts_[size_profile::bucket_count] = {};
+    };
+
+} // namespace detail
+
+
+// The registry of the size profiles of every thread and every small_vector type or call site using sampling_stats.
+class size_profile_registry
+{
+public:
+    static size_profile_registry& instance() noexcept
+    {
+        // never destroyed, so the profiles remain valid for vectors destroyed during static destruction
+        static size_profile_registry* registry = new size_profile_registry;
+        return *registry;
+    }
+
+    // On average 1 in every 'period' destroyed vectors is sampled on each thread. A period of 1 samples every vector.
+    void set_sampling_period(std::uint32_t period) noexcept { sampling_period_.store(std::max(period, 1u), std::memory_order_relaxed); }
+    std::uint32_t sampling_period() const noexcept { return sampling_period_.load(std::memory_order_relaxed); }
+
+    // Add a histogram for the calling thread. Returns nullptr if the histogram couldn't be allocated.
+    detail::size_profile_entry* add_entry(const std::string& name, std::size_t element_size, std::size_t inline_capacity) noexcept
+    {
+        try
+        {
+            std::scoped_lock lock{ mutex_ };
+            return std::addressof(entries_.emplace_back(name, element_size, inline_capacity));
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    // The combined profile of every thread for each small_vector type or call site, sorted by name.
+    std::vector<size_profile> snapshot() const
+    {
+        std::map<std::string, size_profile> totals;
+        {
+            std::scoped_lock lock{ mutex_ };
+            for (const detail::size_profile_entry& entry : entries_)
+            {
+                size_profile profile = entry.load();
+                auto [it, inserted] = totals.try_emplace(profile.name, profile);
+                if (!inserted) it->second += profile;
+            }
+        }
+
+        std::vector<size_profile> profiles;
+        for (auto& [name, profile] : totals) profiles.push_back(std::move(profile));
+        return profiles;
+    }
+
+    // Write the current profiles to 'os' in the format read by read_size_profiles().
+    void dump(std::ostream& os) const { write_size_profiles(os, snapshot()); }
+
+    void reset() noexcept
+    {
+        std::scoped_lock lock{ mutex_ };
+        for (detail::size_profile_entry& entry : entries_) entry.clear();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<detail::size_profile_entry> entries_;
+    std::atomic<std::uint32_t> sampling_period_ = 64;
+};
+
+
+// A statistics policy that samples the size of the vectors when they are destroyed, and records them in thread-local
+// histograms, which can be read using size_profile_registry. The vectors are sampled randomly at the rate set by
+// size_profile_registry::set_sampling_period(), which is low by default, so it can be used in production.
+// The peak capacity is tracked on every allocation instead, since the capacity of a vector may have been reduced by
+// shrink_to_fit() or its shrink policy by the time it is destroyed. Allocations are rare and expensive enough compared
+// to the update that this doesn't need to be sampled.
+// The empty vectors left behind by a move, like the local variables returned from functions, aren't sampled, as they
+// would hide the sizes of the vectors that took over their elements. The moves are only counted per thread and type,
+// so a moved-from vector that is refilled before being destroyed lets one other empty vector go unsampled instead.
+// The histograms are aggregated per vector type or per Tag, the same way as for counting_stats.
+template<typename Tag = void>
+struct sampling_stats
+{
+    template<typename Vector>
+    static void record(stats_event event, const stats_params& params) noexcept
+    {
+        thread_local std::size_t moved_from = 0;
+
+        if (event == stats_event::move)
+        {
+            moved_from++;
+        }
+        else if (event == stats_event::destroy)
+        {
+            if (params.size == 0 && moved_from != 0)
+            {
+                moved_from--;
+                return;
+            }
+
+            thread_local std::uint32_t countdown = 1;
+            if (--countdown != 0) [[likely]] return;
+
+            countdown = next_countdown();
+
+            if (detail::size_profile_entry* entry = thread_entry<Vector>()) entry->add(params.size, params.old_capacity);
+        }
+        else if (event != stats_event::deallocate)
+        {
+            if (detail::size_profile_entry* entry = thread_entry<Vector>()) entry->add_capacity(params.new_capacity);
+        }
+    }
+
+private:
+    // Returns a random countdown in the range [1, 2 * period - 1], so that vectors are sampled at the
+    // rate of 1 / period on average, without aliasing with the periodic patterns of the program.
+    static std::uint32_t next_countdown() noexcept
+    {
+        thread_local std::uint64_t state = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<std::uintptr_t>(&state);
+
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        const std::uint64_t period = size_profile_registry::instance().sampling_period();
+        return std::uint32_t(1 + state % (2 * period - 1));
+    }
+
+    template<typename Vector>
+    static detail::size_profile_entry* thread_entry() noexcept
+    {
+        thread_local detail::size_profile_entry* const entry = register_entry<Vector>();
+        return entry;
+    }
+
+    template<typename Vector>
+    static detail::size_profile_entry* register_entry() noexcept
+    {
+        try
+        {
+            return size_profile_registry::instance().add_entry(counting_stats<Tag>::template name<Vector>(),
+                                                               sizeof(typename Vector::value_type), Vector::inline_capacity());
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+};
+
+// Write a header to 'os' that defines the recommended inline capacity for each profile as an inline constexpr variable in
+// the namespace 'ns'. The names of the variables are the names of the profiles, with the characters that aren't valid in
+// an identifier replaced by underscores, so the profiles should be named using a Tag with a static 'name' member.
+inline void write_size_header(std::ostream& os, const std::vector<size_profile>& profiles, const std::string& ns = "small_vector_sizes", double spill_cost = 64.0)
+{
+    auto identifier = [](const std::string& name)
+    {
+        std::string result;
+        for (char c : name) result += (std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+        if (result.empty() || std::isdigit(static_cast<unsigned char>(result.front()))) result.insert(result.begin(), '_');
+        return result;
+    };
+
+    os << "// Generated from small_vector size profiles. Do not edit.\n\n"
+       << "#pragma once\n\n"
+       << "#include <cstddef>\n\n"
+       << "namespace " << ns << "\n{\n";
+
+    for (const size_profile& profile : profiles)
+    {
+        const std::size_t size = recommend_small_size(profile, spill_cost);
+
+        os << "    // " << profile.name << ": samples=" << profile.samples() << ", spill rate="
+           << profile.spill_rate(size) << " (currently " << profile.spill_rate(profile.inline_capacity) << ")\n"
+           << "    inline constexpr std::size_t " << identifier(profile.name) << " = " << size << ";\n";
+    }
+
+    os << "\n} // namespace " << ns << "\n";
+}
+
+#endif // !SMALL_VECTOR_SMALL_VECTOR_STATS_HPP
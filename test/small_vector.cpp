@@ -4,15 +4,27 @@
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 #include <small_vector.hpp>
+#include <small_vector_stats.hpp>
+#include <small_vector_serialization.hpp>
 #include <algorithm>
 #include <vector>
+#include <unordered_set>
 #include <iterator>
+#include <ranges>
+#include <span>
 #include <memory>
+#include <memory_resource>
 #include <type_traits>
 #include <string>
 #include <sstream>
 #include <utility>
+#include <compare>
+#include <limits>
+#include <bit>
+#include <stdexcept>
+#include <cstring>
 #include <cstddef>
+#include <cstdint>
 
 inline constexpr size_t EMPTY = 0;
 inline constexpr size_t SMALL_SIZE = 4;
@@ -78,6 +90,24 @@ struct NonTrivialType
     int i_ = 0;
 };
 
+struct RelocatableType
+{
+    RelocatableType() : p_(new int(0)) {}
+    RelocatableType(int i) : p_(new int(i)) {}
+    RelocatableType(const RelocatableType& o) : p_(new int(*o.p_)) {}
+    RelocatableType(RelocatableType&& o) noexcept : p_(std::exchange(o.p_, nullptr)) {}
+    RelocatableType& operator=(const RelocatableType& o) { *p_ = *o.p_; return *this; }
+    RelocatableType& operator=(RelocatableType&& o) noexcept { std::swap(p_, o.p_); return *this; }
+    ~RelocatableType() noexcept { delete p_; }
+
+    friend bool operator==(const RelocatableType& lhs, const RelocatableType& rhs) { return *lhs.p_ == *rhs.p_; }
+
+    int* p_;
+};
+
+template<>
+struct is_trivially_relocatable<RelocatableType> : std::true_type {};
+
 template<typename T>
 constexpr auto equal_to(T rhs)
 {
@@ -95,7 +125,159 @@ TEST_CASE("small_vector_size", "[object_layout][!mayfail]") // fails under clang
     STATIC_REQUIRE(std::is_standard_layout_v<small_vector<int>>);
 
     CHECK(sizeof(small_vector<int>) == detail::cache_line_size);
-    CHECK(alignof(small_vector<int>) == detail::cache_line_size);
+    CHECK(alignof(small_vector<int>) == alignof(int*));
+}
+
+struct CacheLineOptions : small_vector_options
+{
+    using alignment = cache_line_alignment;
+};
+
+struct PackedOptions : small_vector_options
+{
+    using alignment = packed_alignment;
+};
+
+TEST_CASE("alignment_policies", "[object_layout][!mayfail]")
+{
+    CHECK(sizeof(small_vector<char, 8>) == 8 + 3 * sizeof(char*));
+    CHECK(alignof(small_vector<char, 8>) == alignof(char*));
+
+    CHECK(sizeof(small_vector<char, 8, std::allocator<char>, CacheLineOptions>) == detail::cache_line_size);
+    CHECK(alignof(small_vector<char, 8, std::allocator<char>, CacheLineOptions>) == detail::cache_line_size);
+
+    STATIC_REQUIRE(small_vector<char, 3, std::allocator<char>, PackedOptions>::inline_capacity() == alignof(char*));
+    STATIC_REQUIRE(small_vector<int, 4, std::allocator<int>, PackedOptions>::inline_capacity() == 4);
+    CHECK(sizeof(small_vector<char, 3, std::allocator<char>, PackedOptions>) == sizeof(small_vector<char, 3>));
+}
+
+TEST_CASE("default_small_size", "[object_layout]")
+{
+    STATIC_REQUIRE(detail::default_small_size_v<char> == detail::cache_line_size - 3 * sizeof(char*));
+    STATIC_REQUIRE(detail::default_small_size_v<int> == (detail::cache_line_size - 3 * sizeof(int*)) / sizeof(int));
+    STATIC_REQUIRE(detail::default_small_size_v<char[32]> == 2);
+    STATIC_REQUIRE(detail::default_small_size_v<char[256]> == 1);
+    STATIC_REQUIRE(detail::default_small_size_v<char[256], 1024> == 4);
+}
+
+TEST_CASE("compact_small_vector_size", "[object_layout][!mayfail]")
+{
+    STATIC_REQUIRE(std::is_standard_layout_v<compact_small_vector<int>>);
+
+    CHECK(sizeof(compact_small_vector<int, 12>) < sizeof(small_vector<int, 12>));
+    CHECK(sizeof(compact_small_vector<int, 2>) == 2 * sizeof(int) + sizeof(int*) + 2 * sizeof(std::uint32_t));
+}
+
+struct ByteSizeOptions : small_vector_options
+{
+    using layout = compact_layout<std::uint8_t>;
+};
+
+TEST_CASE("compact_layout_max_size", "[object_layout]")
+{
+    small_vector<int, 4, std::allocator<int>, ByteSizeOptions> vec(255);
+
+    REQUIRE(vec.max_size() == 255);
+    REQUIRE(vec.capacity() == 255);
+    REQUIRE_THROWS_AS(vec.push_back(1), std::length_error);
+    REQUIRE_THROWS_AS(vec.reserve(256), std::length_error);
+}
+
+// Allocates more elements than requested, and remembers the sizes of the allocations to check that the storage
+// is deallocated with the same size.
+template<typename T>
+struct GenerousAllocator
+{
+    using value_type = T;
+
+    struct allocation_result { T* ptr; std::size_t count; };
+
+    GenerousAllocator() = default;
+    template<typename U>
+    GenerousAllocator(const GenerousAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count)
+    {
+        T* const data = std::allocator<T>{}.allocate(count);
+        sizes.emplace_back(data, count);
+        return data;
+    }
+
+    allocation_result allocate_at_least(std::size_t count)
+    {
+        const std::size_t extra = 1000;
+        return { allocate(count + extra), count + extra };
+    }
+
+    void deallocate(T* data, std::size_t count) noexcept
+    {
+        auto it = std::find_if(sizes.begin(), sizes.end(), [&](const auto& size) { return size.first == data; });
+        if (it == sizes.end() || it->second != count) size_mismatches++;
+        if (it != sizes.end()) sizes.erase(it);
+        std::allocator<T>{}.deallocate(data, count);
+    }
+
+    friend bool operator==(const GenerousAllocator&, const GenerousAllocator&) = default;
+
+    static inline std::vector<std::pair<T*, std::size_t>> sizes;
+    static inline std::size_t size_mismatches = 0;
+};
+
+TEST_CASE("compact_layout_allocate_at_least", "[object_layout]")
+{
+    using Alloc = GenerousAllocator<int>;
+    Alloc::size_mismatches = 0;
+
+    {
+        small_vector<int, 4, Alloc, ByteSizeOptions> vec(100);
+        REQUIRE(vec.capacity() <= vec.max_size());
+
+        vec.resize(200);
+        REQUIRE(vec.capacity() <= vec.max_size());
+        vec.shrink_to_fit();
+    }
+
+    REQUIRE(Alloc::size_mismatches == 0);
+    REQUIRE(Alloc::sizes.empty());
+}
+
+TEMPLATE_TEST_CASE("compact_layout", "[object_layout]", TrivialType, NonTrivialType)
+{
+    const size_t size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
+
+    compact_small_vector<TestType, SMALL_SIZE> vec;
+    std::vector<TestType> expected;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        vec.push_back(TestType(int(i)));
+        expected.push_back(TestType(int(i)));
+    }
+
+    REQUIRE(vec.size() == size);
+    REQUIRE(vec.capacity() >= size);
+    REQUIRE(vec.is_small() == (size <= SMALL_SIZE));
+    REQUIRE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+
+    vec.insert(vec.begin(), 3, TestType{ 7 });
+    expected.insert(expected.begin(), 3, TestType{ 7 });
+    vec.erase(vec.begin() + 1);
+    expected.erase(expected.begin() + 1);
+
+    REQUIRE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+
+    compact_small_vector<TestType, SMALL_SIZE> other(std::move(vec));
+    REQUIRE(vec.empty());
+    REQUIRE(std::equal(other.begin(), other.end(), expected.begin(), expected.end()));
+
+    vec = other;
+    vec.swap(other);
+    REQUIRE(vec == other);
+
+    vec.resize(1);
+    vec.shrink_to_fit();
+    REQUIRE(vec.size() == 1);
+    REQUIRE(vec.front() == TestType{ 7 });
 }
 
 
@@ -148,6 +330,16 @@ TEMPLATE_TEST_CASE("small_vector(size_t, Alloc)", "[constructor]", TrivialType,
     REQUIRE(vec.capacity() >= size);
 }
 
+TEMPLATE_TEST_CASE("small_vector(size_t, default_init_t)", "[constructor]", TrivialType, MoveOnlyType, ImmovableType, NonTrivialType)
+{
+    const size_t size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
+
+    small_vector<TestType> vec(size, default_init);
+
+    REQUIRE(vec.size() == size);
+    REQUIRE(vec.capacity() >= size);
+}
+
 TEMPLATE_TEST_CASE("small_vector(size_t, const T&)", "[constructor]", TrivialType, NonTrivialType, NonDefaultConstructibleType)
 {
     const size_t size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
@@ -261,7 +453,7 @@ TEMPLATE_TEST_CASE("small_vector(const small_vector&, Alloc)", "[constructor]",
     REQUIRE(vec.capacity() != 0);
 }
 
-TEMPLATE_TEST_CASE("small_vector(small_vector&&)", "[constructor]", TrivialType, NonTrivialType, NonDefaultConstructibleType)
+TEMPLATE_TEST_CASE("small_vector(small_vector&&)", "[constructor]", TrivialType, NonTrivialType, NonDefaultConstructibleType, RelocatableType)
 {
     const size_t size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
 
@@ -383,7 +575,7 @@ TEMPLATE_TEST_CASE("operator=(const small_vector&)", "[assignment]", TrivialType
     REQUIRE(dest == source);
 }
 
-TEMPLATE_TEST_CASE("operator=(small_vector&&)", "[assignment]", TrivialType, NonTrivialType, NonDefaultConstructibleType)
+TEMPLATE_TEST_CASE("operator=(small_vector&&)", "[assignment]", TrivialType, NonTrivialType, NonDefaultConstructibleType, RelocatableType)
 {
     const size_t src_size = GENERATE(EMPTY, SMALL_SIZE - 1, LARGE_SIZE + 1);
     const size_t dest_size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
@@ -471,6 +663,90 @@ TEMPLATE_TEST_CASE("front/back", "[element_access]", TrivialType, NonTrivialType
     REQUIRE(vec.back() == TestType{ 3 });
 }
 
+    //-----------------------------------//
+    //               LOOKUP              //
+    //-----------------------------------//
+
+
+TEMPLATE_TEST_CASE("find/count", "[lookup]", std::int8_t, std::uint16_t, std::int32_t, std::uint64_t, float, double, NonTrivialType)
+{
+    const size_t size = GENERATE(EMPTY, 1, SMALL_SIZE, 7, 15, 33, LARGE_SIZE, 1000);
+    const size_t capacity = GENERATE(EMPTY, 1000);
+
+    small_vector<TestType, 8> vec;
+    vec.reserve(capacity);
+    for (size_t i = 0; i < size; i++) vec.push_back(TestType(int(i % 50)));
+
+    for (const int value : { 0, 1, 7, 32, 49, 50, -1 })
+    {
+        const auto expected = std::find(vec.begin(), vec.end(), TestType(value));
+
+        REQUIRE(vec.find(TestType(value)) == expected);
+        REQUIRE(std::as_const(vec).find(TestType(value)) == expected);
+        REQUIRE(vec.index_of(TestType(value)) == size_t(expected - vec.begin()));
+        REQUIRE(vec.contains(TestType(value)) == (expected != vec.end()));
+        REQUIRE(vec.count(TestType(value)) == size_t(std::count(vec.begin(), vec.end(), TestType(value))));
+    }
+}
+
+TEST_CASE("find/count_floating_point", "[lookup]")
+{
+    small_vector<double> vec{ 1.0, -0.0, std::numeric_limits<double>::quiet_NaN(), 0.0 };
+
+    REQUIRE(vec.index_of(0.0) == 1);
+    REQUIRE(vec.count(-0.0) == 2);
+    REQUIRE(!vec.contains(std::numeric_limits<double>::quiet_NaN()));
+
+    vec.resize(100, 1.0);
+    REQUIRE(vec.index_of(0.0) == 1);
+    REQUIRE(vec.count(1.0) == 97);
+    REQUIRE(!vec.contains(std::numeric_limits<double>::quiet_NaN()));
+}
+
+TEST_CASE("find/count_constexpr", "[lookup]")
+{
+    constexpr auto index = []
+    {
+        small_vector<int> vec{ 1, 2, 3, 2 };
+        return vec.index_of(2) + 10 * vec.count(2);
+    }();
+
+    STATIC_REQUIRE(index == 21);
+}
+
+#if SV_X86_SIMD
+TEMPLATE_TEST_CASE("find_kernels", "[lookup]", std::int8_t, std::int16_t, std::int32_t, std::int64_t, float, double)
+{
+    const int value = GENERATE(0, 1, 63, 99, 100);
+
+    for (size_t size = 0; size < 140; size++)
+    {
+        std::vector<TestType> vec(size);
+        for (size_t i = 0; i < size; i++) vec[i] = TestType(int(i % 100));
+
+        const TestType* first = vec.data();
+        const TestType* last = vec.data() + vec.size();
+
+        const TestType* expected = std::find(first, last, TestType(value));
+        const size_t expected_count = size_t(std::count(first, last, TestType(value)));
+
+        REQUIRE(detail::find_sse2(first, last, TestType(value)) == expected);
+        REQUIRE(detail::count_sse2(first, last, TestType(value)) == expected_count);
+
+        if (detail::cpu_has_avx2())
+        {
+            REQUIRE(detail::find_avx2(first, last, TestType(value)) == expected);
+            REQUIRE(detail::count_avx2(first, last, TestType(value)) == expected_count);
+        }
+        if (detail::cpu_has_avx512bw())
+        {
+            REQUIRE(detail::find_avx512(first, last, TestType(value)) == expected);
+            REQUIRE(detail::count_avx512(first, last, TestType(value)) == expected_count);
+        }
+    }
+}
+#endif
+
     //-----------------------------------//
     //              CAPACITY             //
     //-----------------------------------//
@@ -505,12 +781,301 @@ TEMPLATE_TEST_CASE("shrink_to_fit", "[capacity]", TrivialType, NonTrivialType)
 
     vec.shrink_to_fit();
     REQUIRE(vec.capacity() == LARGE_SIZE);
+
+    vec.resize(2);
+    vec.shrink_to_fit();
+    REQUIRE(vec.is_small());
+    REQUIRE(vec.capacity() == vec.inline_capacity());
+    REQUIRE(vec == small_vector(2, TestType{ 2 }));
+}
+
+template<typename Growth>
+struct GrowthOptions : small_vector_options
+{
+    using growth = Growth;
+};
+
+template<typename Growth>
+using growth_small_vector = small_vector<int, 4, std::allocator<int>, GrowthOptions<Growth>>;
+
+TEST_CASE("growth_policies", "[capacity]")
+{
+    growth_small_vector<growth_factor_1_5> vec1(4);
+    vec1.push_back(1);
+    REQUIRE(vec1.capacity() == 6);
+
+    growth_small_vector<growth_factor_2> vec2(4);
+    vec2.push_back(1);
+    REQUIRE(vec2.capacity() == 8);
+    vec2.resize(9);
+    REQUIRE(vec2.capacity() == 16);
+
+    growth_small_vector<power_of_two_growth> vec3(4);
+    vec3.push_back(1);
+    REQUIRE(vec3.capacity() * sizeof(int) == std::bit_ceil(5 * sizeof(int)));
+    vec3.resize(100);
+    REQUIRE(std::has_single_bit(vec3.capacity() * sizeof(int)));
+
+    growth_small_vector<exact_growth> vec4(4);
+    vec4.push_back(1);
+    REQUIRE(vec4.capacity() == 5);
+    vec4.insert(vec4.begin(), 3, 2);
+    REQUIRE(vec4.capacity() == 8);
+
+    growth_small_vector<first_spill_growth<32, growth_factor_2>> vec5(4);
+    vec5.push_back(1);
+    REQUIRE(vec5.capacity() == 32);
+    vec5.resize(33);
+    REQUIRE(vec5.capacity() == 64);
+}
+
+struct ShrinkOptions : small_vector_options
+{
+    using shrink = hysteresis_shrink<1, 4>;
+};
+
+TEMPLATE_TEST_CASE("shrink_policies", "[capacity]", TrivialType, NonTrivialType)
+{
+    small_vector<TestType, 4, std::allocator<TestType>, ShrinkOptions> vec(LARGE_SIZE, TestType{ 3 });
+    REQUIRE(vec.capacity() == LARGE_SIZE);
+
+    vec.erase(vec.begin() + 30, vec.end());
+    REQUIRE(vec.capacity() == LARGE_SIZE);
+
+    vec.erase(vec.begin() + 20, vec.end());
+    REQUIRE(vec.size() == 20);
+    REQUIRE(vec.capacity() == 40);
+
+    vec.resize(9);
+    REQUIRE(vec.capacity() == 18);
+
+    vec.pop_back();
+    vec.pop_back();
+    vec.pop_back();
+    vec.pop_back();
+    REQUIRE(vec.size() == 5);
+    REQUIRE(vec.capacity() == 18);
+
+    vec.erase(vec.begin(), vec.begin() + 3);
+    REQUIRE(vec.is_small());
+    REQUIRE(vec.size() == 2);
+    REQUIRE(std::all_of(vec.begin(), vec.end(), equal_to(TestType{ 3 })));
+}
+
+TEMPLATE_TEST_CASE("shrink_policies_erase_iterator", "[capacity]", TrivialType, NonTrivialType)
+{
+    small_vector<TestType, 4, std::allocator<TestType>, ShrinkOptions> vec;
+    for (int i = 0; i < int(LARGE_SIZE); i++) vec.emplace_back(i);
+
+    SECTION("erase")
+    {
+        const TestType* const old_data = vec.data();
+        auto it = vec.erase(vec.begin() + 10, vec.end() - 10);
+
+        REQUIRE(vec.data() != old_data);
+        REQUIRE(vec.size() == 20);
+        REQUIRE(it - vec.begin() == 10);
+        REQUIRE(*it == TestType{ int(LARGE_SIZE) - 10 });
+
+        // erasing the elements one by one using the returned iterator, which stays valid across the shrinks
+        it = vec.begin() + 1;
+        while (it != vec.end()) it = vec.erase(it);
+
+        REQUIRE(vec.capacity() < 20);
+        REQUIRE(vec.size() == 1);
+        REQUIRE(vec.front() == TestType{ 0 });
+    }
+    SECTION("erase_unordered")
+    {
+        auto it = vec.begin() + 1;
+        while (it != vec.end()) it = vec.erase_unordered(it);
+
+        REQUIRE(vec.capacity() < 20);
+        REQUIRE(vec.size() == 1);
+        REQUIRE(vec.front() == TestType{ 0 });
+    }
 }
 
     //-----------------------------------//
     //             MODIFIERS             //
     //-----------------------------------//
 
+struct StatsTag { static constexpr const char* name = "stats_test"; };
+
+struct StatsOptions : small_vector_options
+{
+    using stats = counting_stats<StatsTag>;
+};
+
+TEST_CASE("counting_stats", "[capacity]")
+{
+    stats_registry::instance().reset();
+
+    {
+        small_vector<int, 4, std::allocator<int>, StatsOptions> vec(2);
+
+        vec.resize(SMALL_SIZE);
+        REQUIRE(stats_registry::instance().get("stats_test") == stats_counters{});
+
+        vec.push_back(1);
+        vec.insert(vec.begin(), 0);
+        vec.insert(vec.begin(), LARGE_SIZE, 0);
+        vec.reserve(4 * LARGE_SIZE);
+        vec.shrink_to_fit();
+    }
+
+    const stats_counters counters = stats_registry::instance().get("stats_test");
+
+    REQUIRE(counters.spills == 1);
+    REQUIRE(counters.reallocate_append == 1);
+    REQUIRE(counters.reallocate_emplace <= 1);
+    REQUIRE(counters.reallocate_insert == 1);
+    REQUIRE(counters.reallocate == 2);
+    REQUIRE(counters.allocations() == counters.deallocate);
+    REQUIRE(counters.relocated_bytes >= (SMALL_SIZE + 2 * (LARGE_SIZE + SMALL_SIZE + 2)) * sizeof(int));
+
+    std::ostringstream os;
+    stats_registry::instance().dump(os);
+    REQUIRE(os.str().find("stats_test: spills=1") != std::string::npos);
+}
+
+TEST_CASE("counting_stats_constructors", "[capacity]")
+{
+    stats_registry::instance().reset();
+
+    {
+        small_vector<int, 4, std::allocator<int>, StatsOptions> small(SMALL_SIZE);
+        small_vector<int, 4, std::allocator<int>, StatsOptions> large(LARGE_SIZE);
+        small_vector<int, 4, std::allocator<int>, StatsOptions> copy(large);
+        small_vector<int, 4, std::allocator<int>, StatsOptions> range(large.begin(), large.end());
+    }
+
+    const stats_counters counters = stats_registry::instance().get("stats_test");
+
+    REQUIRE(counters.spills == 3);
+    REQUIRE(counters.allocate == 3);
+    REQUIRE(counters.deallocate == 3);
+}
+
+struct ProfileTag { static constexpr const char* name = "profile.test"; };
+
+struct ProfileOptions : small_vector_options
+{
+    using stats = sampling_stats<ProfileTag>;
+};
+
+TEST_CASE("sampling_stats", "[capacity]")
+{
+    size_profile_registry& registry = size_profile_registry::instance();
+    registry.reset();
+    registry.set_sampling_period(1);
+
+    for (size_t size = 0; size < 2 * LARGE_SIZE; size++)
+    {
+        small_vector<int, 4, std::allocator<int>, ProfileOptions> vec(size % LARGE_SIZE);
+    }
+
+    registry.set_sampling_period(64);
+
+    const std::vector<size_profile> profiles = registry.snapshot();
+    const auto profile = std::ranges::find(profiles, "profile.test", &size_profile::name);
+
+    REQUIRE(profile != profiles.end());
+    REQUIRE(profile->samples() >= 2 * LARGE_SIZE - 1);
+    REQUIRE(profile->inline_capacity == 4);
+    REQUIRE(profile->element_size == sizeof(int));
+    REQUIRE(profile->peak_capacity >= LARGE_SIZE - 1);
+    REQUIRE(profile->counts[SMALL_SIZE] >= 1);
+}
+
+TEST_CASE("sampling_stats_peak_capacity", "[capacity]")
+{
+    size_profile_registry& registry = size_profile_registry::instance();
+    registry.reset();
+    registry.set_sampling_period(1);
+
+    {
+        small_vector<int, 4, std::allocator<int>, ProfileOptions> vec(LARGE_SIZE);
+        vec.resize(SMALL_SIZE);
+        vec.shrink_to_fit();
+        REQUIRE(vec.is_small());
+    }
+
+    registry.set_sampling_period(64);
+
+    const std::vector<size_profile> profiles = registry.snapshot();
+    const auto profile = std::ranges::find(profiles, "profile.test", &size_profile::name);
+
+    REQUIRE(profile != profiles.end());
+    REQUIRE(profile->peak_capacity >= LARGE_SIZE);
+    REQUIRE(profile->counts[SMALL_SIZE] == 1);
+}
+
+TEST_CASE("sampling_stats_moved_from", "[capacity]")
+{
+    using vector_type = small_vector<int, 4, std::allocator<int>, ProfileOptions>;
+
+    size_profile_registry& registry = size_profile_registry::instance();
+    registry.reset();
+    registry.set_sampling_period(1);
+
+    // the parameter is moved into the return value, and then destroyed empty
+    auto append = [](vector_type vec, int value) { vec.push_back(value); return vec; };
+
+    {
+        std::vector<vector_type> vectors;
+        for (size_t i = 0; i < LARGE_SIZE; i++)
+        {
+            vectors.push_back(append(append(vector_type(i % 2 ? 1 : SMALL_SIZE), 1), 2));
+        }
+        vector_type last;
+        last = std::move(vectors.back());
+        vectors.pop_back();
+    }
+
+    registry.set_sampling_period(64);
+
+    const std::vector<size_profile> profiles = registry.snapshot();
+    const auto profile = std::ranges::find(profiles, "profile.test", &size_profile::name);
+
+    REQUIRE(profile != profiles.end());
+    REQUIRE(profile->samples() == LARGE_SIZE);
+    REQUIRE(profile->counts[0] == 0);
+    REQUIRE(profile->counts[3] == LARGE_SIZE / 2);
+    REQUIRE(profile->counts[SMALL_SIZE + 2] == LARGE_SIZE / 2);
+    REQUIRE(recommend_small_size(*profile) >= 3);
+}
+
+TEST_CASE("recommend_small_size", "[capacity]")
+{
+    size_profile profile{ "tokens", sizeof(int), 4 };
+
+    profile.counts[3] = 900;
+    profile.counts[12] = 10;
+    profile.counts[size_profile::bucket_of(10'000)] = 1;
+
+    REQUIRE(profile.samples() == 911);
+    REQUIRE(profile.spill_rate(3) == 11.0 / 911.0);
+    REQUIRE(profile.spill_rate(12) == 1.0 / 911.0);
+    REQUIRE(recommend_small_size(profile) == 3);
+    REQUIRE(recommend_small_size(profile, 10'000.0) == 12);
+
+    std::stringstream dump;
+    write_size_profiles(dump, { profile });
+
+    const std::vector<size_profile> profiles = read_size_profiles(dump);
+    REQUIRE(profiles.size() == 1);
+    REQUIRE(profiles[0].name == "tokens");
+    REQUIRE(profiles[0].counts == profile.counts);
+
+    std::ostringstream header;
+    write_size_header(header, profiles);
+    REQUIRE(header.str().find("inline constexpr std::size_t tokens = 3;") != std::string::npos);
+
+    std::istringstream invalid("profile tokens x\n");
+    REQUIRE_THROWS(read_size_profiles(invalid));
+}
+
 TEMPLATE_TEST_CASE("clear", "[modifiers]", TrivialType, NonTrivialType)
 {
     const size_t size = GENERATE(SMALL_SIZE, LARGE_SIZE);
@@ -521,9 +1086,9 @@ TEMPLATE_TEST_CASE("clear", "[modifiers]", TrivialType, NonTrivialType)
     REQUIRE(vec.empty());
 }
 
-TEMPLATE_TEST_CASE("swap", "[modifiers]", TrivialType, NonTrivialType)
+TEMPLATE_TEST_CASE("swap", "[modifiers]", TrivialType, NonTrivialType, RelocatableType)
 {
-    const size_t left_size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+    const size_t left_size = GENERATE(1, SMALL_SIZE, LARGE_SIZE);
     const size_t right_size = GENERATE(SMALL_SIZE, LARGE_SIZE);
 
     small_vector left(left_size, TestType{ 1 });
@@ -611,41 +1176,105 @@ TEMPLATE_TEST_CASE("resize(n)", "[modifiers]", TrivialType, NonTrivialType, Move
     REQUIRE(vec.empty());
 }
 
-TEMPLATE_TEST_CASE("resize(n, value)", "[modifiers]", TrivialType, NonTrivialType, NonDefaultConstructibleType)
+TEMPLATE_TEST_CASE("resize_default_init(n)", "[modifiers]", TrivialType, NonTrivialType, MoveOnlyType)
 {
     const size_t size = GENERATE(SMALL_SIZE, LARGE_SIZE);
-    small_vector vec(size, TestType{ 1 });
+    small_vector<TestType> vec(size);
+    for (auto& elem : vec) elem = TestType{ 1 };
 
-    vec.resize(2 * LARGE_SIZE, TestType{ 2 });
+    vec.resize_default_init(2 * LARGE_SIZE);
     REQUIRE(vec.size() == 2 * LARGE_SIZE);
+    REQUIRE(std::all_of(vec.begin(), vec.begin() + size, [](const TestType& elem) { return elem == TestType{ 1 }; }));
+
+    for (auto& elem : vec) elem = TestType{ 2 };
     REQUIRE(vec.back() == TestType{ 2 });
 
-    vec.resize(0, TestType{ 3 });
+    vec.resize_for_overwrite(SMALL_SIZE);
+    REQUIRE(vec.size() == SMALL_SIZE);
+    REQUIRE(vec.back() == TestType{ 2 });
+
+    vec.resize_for_overwrite(0);
     REQUIRE(vec.empty());
 }
 
-TEMPLATE_TEST_CASE("erase(pos)", "[modifiers]", TrivialType, NonTrivialType, MoveOnlyType)
+TEST_CASE("resize_and_overwrite(n, op)", "[modifiers]")
+{
+    const size_t size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
+    small_vector<char> vec(2, 'a');
+
+    vec.resize_and_overwrite(size + 2, [](char* data, size_t count)
+    {
+        std::fill(data + 2, data + count, 'b');
+        return count;
+    });
+
+    REQUIRE(vec.size() == size + 2);
+    REQUIRE(vec.front() == 'a');
+    REQUIRE(std::count(vec.begin(), vec.end(), 'b') == std::ptrdiff_t(size));
+
+    vec.resize_and_overwrite(2, [](char* data, size_t) { data[1] = 'c'; return 1; });
+    REQUIRE(vec.size() == 1);
+    REQUIRE(vec.front() == 'a');
+}
+
+TEST_CASE("append_uninitialized(n)", "[modifiers]")
 {
     const size_t size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+    small_vector<int> vec(SMALL_SIZE, 1);
 
-    small_vector<TestType> vec(size);
-    vec.front() = TestType{ 2 };
+    std::span<int> tail = vec.append_uninitialized(size);
 
-    auto it1 = vec.erase(vec.begin());
+    REQUIRE(tail.size() == size);
+    REQUIRE(tail.data() == vec.data() + SMALL_SIZE);
+    REQUIRE(vec.size() == SMALL_SIZE);
+    REQUIRE(vec.capacity() >= SMALL_SIZE + size);
 
-    REQUIRE(it1 == vec.begin());
-    REQUIRE(vec.size() == size - 1);
-    REQUIRE(vec.front() == TestType{});
+    std::fill(tail.begin(), tail.end(), 2);
+    vec.commit(size - 1);
 
-    auto it2 = vec.erase(vec.end() - 1);
+    REQUIRE(vec.size() == SMALL_SIZE + size - 1);
+    REQUIRE(vec.front() == 1);
+    REQUIRE(vec.back() == 2);
 
-    REQUIRE(it2 == vec.end());
-    REQUIRE(vec.size() == size - 2);
+    vec.commit(0);
+    REQUIRE(vec.size() == SMALL_SIZE + size - 1);
 }
 
-TEMPLATE_TEST_CASE("erase(first, last)", "[modifiers]", TrivialType, NonTrivialType)
+TEMPLATE_TEST_CASE("resize(n, value)", "[modifiers]", TrivialType, NonTrivialType, NonDefaultConstructibleType)
 {
-    small_vector vec{ TestType{ 0 }, TestType{ 1 }, TestType{ 2 }, TestType{ 3 }, TestType{ 4 } };
+    const size_t size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+    small_vector vec(size, TestType{ 1 });
+
+    vec.resize(2 * LARGE_SIZE, TestType{ 2 });
+    REQUIRE(vec.size() == 2 * LARGE_SIZE);
+    REQUIRE(vec.back() == TestType{ 2 });
+
+    vec.resize(0, TestType{ 3 });
+    REQUIRE(vec.empty());
+}
+
+TEMPLATE_TEST_CASE("erase(pos)", "[modifiers]", TrivialType, NonTrivialType, MoveOnlyType, RelocatableType)
+{
+    const size_t size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+
+    small_vector<TestType> vec(size);
+    vec.front() = TestType{ 2 };
+
+    auto it1 = vec.erase(vec.begin());
+
+    REQUIRE(it1 == vec.begin());
+    REQUIRE(vec.size() == size - 1);
+    REQUIRE(vec.front() == TestType{});
+
+    auto it2 = vec.erase(vec.end() - 1);
+
+    REQUIRE(it2 == vec.end());
+    REQUIRE(vec.size() == size - 2);
+}
+
+TEMPLATE_TEST_CASE("erase(first, last)", "[modifiers]", TrivialType, NonTrivialType, RelocatableType)
+{
+    small_vector vec{ TestType{ 0 }, TestType{ 1 }, TestType{ 2 }, TestType{ 3 }, TestType{ 4 } };
 
     SECTION("front")
     {
@@ -685,7 +1314,98 @@ TEMPLATE_TEST_CASE("erase(first, last)", "[modifiers]", TrivialType, NonTrivialT
     }
 }
 
-TEMPLATE_TEST_CASE("insert(pos, const T&)", "[modifiers]", TrivialType, NonTrivialType)
+TEMPLATE_TEST_CASE("erase_unordered(pos)", "[modifiers]", TrivialType, NonTrivialType, MoveOnlyType, RelocatableType)
+{
+    const size_t size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+    small_vector<TestType> vec;
+    for (size_t i = 0; i < size; i++) vec.emplace_back(int(i));
+
+    auto it = vec.erase_unordered(vec.begin() + 1);
+
+    REQUIRE(vec.size() == size - 1);
+    REQUIRE(it == vec.begin() + 1);
+    REQUIRE(*it == TestType{ int(size) - 1 });
+    REQUIRE(vec.back() == TestType{ int(size) - 2 });
+
+    it = vec.erase_unordered(vec.end() - 1);
+
+    REQUIRE(vec.size() == size - 2);
+    REQUIRE(it == vec.end());
+}
+
+TEMPLATE_TEST_CASE("erase_if(pred)", "[modifiers]", std::int8_t, std::int32_t, std::uint32_t, float, std::int64_t, double, NonTrivialType)
+{
+    const size_t size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE, 1000);
+    const int modulo = GENERATE(1, 2, 3, 7, 100);
+
+    small_vector<TestType> vec;
+    std::vector<TestType> expected;
+    for (size_t i = 0; i < size; i++)
+    {
+        vec.push_back(TestType(int(i % 101)));
+        expected.push_back(TestType(int(i % 101)));
+    }
+
+    auto pred = [&](const TestType& elem)
+    {
+        if constexpr (std::is_arithmetic_v<TestType>) return int(elem) % modulo != 0;
+        else return elem.i_ % modulo != 0;
+    };
+
+    const auto erased = vec.erase_if(pred);
+    std::erase_if(expected, pred);
+
+    REQUIRE(erased == size - expected.size());
+    REQUIRE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+}
+
+#if SV_X86_SIMD
+TEMPLATE_TEST_CASE("remove_if_kernels", "[modifiers]", std::int32_t, double)
+{
+    const int modulo = GENERATE(1, 2, 3, 100);
+
+    std::vector<TestType> src(1000);
+    for (size_t i = 0; i < src.size(); i++) src[i] = TestType(int(i % 101));
+
+    auto pred = [&](TestType elem) { return int(elem) % modulo == 0; };
+
+    std::vector<TestType> expected = src;
+    std::erase_if(expected, pred);
+
+    std::vector<TestType> vec = src;
+    vec.resize(size_t(detail::remove_if_branchless(vec.data(), vec.data() + vec.size(), vec.data(), pred) - vec.data()));
+    REQUIRE(vec == expected);
+
+    if (detail::cpu_has_sse42())
+    {
+        vec = src;
+        vec.resize(size_t(detail::remove_if_sse42(vec.data(), vec.data() + vec.size(), vec.data(), pred) - vec.data()));
+        REQUIRE(vec == expected);
+    }
+    if (detail::cpu_has_avx2())
+    {
+        vec = src;
+        vec.resize(size_t(detail::remove_if_avx2(vec.data(), vec.data() + vec.size(), vec.data(), pred) - vec.data()));
+        REQUIRE(vec == expected);
+    }
+}
+#endif
+
+TEST_CASE("erase(vec, value)", "[modifiers]")
+{
+    small_vector<int> vec{ 1, 2, 1, 3, 1, 4, 5, 1, 6, 7, 8, 1 };
+
+    REQUIRE(erase(vec, 1) == 5);
+    REQUIRE(vec == small_vector<int>{ 2, 3, 4, 5, 6, 7, 8 });
+
+    REQUIRE(erase_if(vec, [](int i) { return i % 2 == 0; }) == 4);
+    REQUIRE(vec == small_vector<int>{ 3, 5, 7 });
+
+    REQUIRE(erase(vec, 10) == 0);
+    REQUIRE(vec.size() == 3);
+}
+
+TEMPLATE_TEST_CASE("insert(pos, const T&)", "[modifiers]", TrivialType, NonTrivialType, RelocatableType)
 {
     small_vector vec{ TestType{ 0 }, TestType{ 1 }, TestType{ 2 }, TestType{ 3 } };
     const TestType value{ 21 };
@@ -721,7 +1441,7 @@ TEMPLATE_TEST_CASE("insert(pos, const T&)", "[modifiers]", TrivialType, NonTrivi
     }
 }
 
-TEMPLATE_TEST_CASE("insert(pos, T&&)", "[modifiers]", TrivialType, NonTrivialType)
+TEMPLATE_TEST_CASE("insert(pos, T&&)", "[modifiers]", TrivialType, NonTrivialType, RelocatableType)
 {
     small_vector vec{ TestType{ 0 }, TestType{ 1 }, TestType{ 2 }, TestType{ 3 } };
 
@@ -757,7 +1477,7 @@ TEMPLATE_TEST_CASE("insert(pos, T&&)", "[modifiers]", TrivialType, NonTrivialTyp
     }
 }
 
-TEMPLATE_TEST_CASE("insert(pos, count, const T&)", "[modifiers]", TrivialType, NonTrivialType)
+TEMPLATE_TEST_CASE("insert(pos, count, const T&)", "[modifiers]", TrivialType, NonTrivialType, RelocatableType)
 {
     small_vector dest{ TestType{ 0 }, TestType{ 1 } };
 
@@ -792,6 +1512,15 @@ TEMPLATE_TEST_CASE("insert(pos, count, const T&)", "[modifiers]", TrivialType, N
         REQUIRE(dest == small_vector{ TestType{ 0 }, TestType{ 1 } });
         REQUIRE(it == dest.end());
     }
+    SECTION("shift")
+    {
+        dest.reserve(20);
+        dest.insert(dest.end(), { TestType{ 2 }, TestType{ 3 }, TestType{ 5 }, TestType{ 6 } });
+        auto it = dest.insert(dest.begin() + 1, 2, TestType{ 4 });
+
+        REQUIRE(dest == small_vector{ TestType{ 0 }, TestType{ 4 }, TestType{ 4 }, TestType{ 1 }, TestType{ 2 }, TestType{ 3 }, TestType{ 5 }, TestType{ 6 } });
+        REQUIRE(it == (dest.begin() + 1));
+    }
     SECTION("many")
     {
         for (size_t i = 0; i < 100; i++) dest.insert(dest.begin(), 3, TestType{ 4 });
@@ -802,7 +1531,7 @@ TEMPLATE_TEST_CASE("insert(pos, count, const T&)", "[modifiers]", TrivialType, N
     }
 }
 
-TEMPLATE_TEST_CASE("insert(pos, FwdIter, FwdIter)", "[modifiers]", TrivialType, NonTrivialType)
+TEMPLATE_TEST_CASE("insert(pos, FwdIter, FwdIter)", "[modifiers]", TrivialType, NonTrivialType, RelocatableType)
 {
     small_vector dest{ TestType{ 0 }, TestType{ 1 } };
     const small_vector src{ TestType{ 2 }, TestType{ 3 }, TestType{ 4 } };
@@ -835,6 +1564,15 @@ TEMPLATE_TEST_CASE("insert(pos, FwdIter, FwdIter)", "[modifiers]", TrivialType,
         REQUIRE(dest == small_vector{ TestType{ 0 }, TestType{ 1 } });
         REQUIRE(it == dest.end());
     }
+    SECTION("shift")
+    {
+        dest.reserve(20);
+        dest.insert(dest.end(), { TestType{ 5 }, TestType{ 6 }, TestType{ 7 }, TestType{ 8 } });
+        auto it = dest.insert(dest.begin() + 1, src.begin(), src.end());
+
+        REQUIRE(dest == small_vector{ TestType{ 0 }, TestType{ 2 }, TestType{ 3 }, TestType{ 4 }, TestType{ 1 }, TestType{ 5 }, TestType{ 6 }, TestType{ 7 }, TestType{ 8 } });
+        REQUIRE(*it == TestType{ 2 });
+    }
     SECTION("many")
     {
         for (size_t i = 0; i < 100; i++) dest.insert(dest.begin(), src.begin(), src.end());
@@ -845,6 +1583,44 @@ TEMPLATE_TEST_CASE("insert(pos, FwdIter, FwdIter)", "[modifiers]", TrivialType,
     }
 }
 
+// Inserting fewer elements than there are after pos without reallocating must shift every element after pos,
+// not only the ones that are relocated into the uninitialized storage.
+TEMPLATE_TEST_CASE("insert_with_capacity_shifts_tail", "[modifiers]", TrivialType, NonTrivialType)
+{
+    const size_t size = GENERATE(3, 8, LARGE_SIZE);
+    const size_t count = GENERATE(1, 2);
+    const size_t offset = GENERATE(0, 1);
+
+    small_vector<TestType> vec;
+    vec.reserve(size + count);
+    std::vector<TestType> expected;
+    for (size_t i = 0; i < size; i++)
+    {
+        vec.emplace_back(int(i));
+        expected.emplace_back(int(i));
+    }
+
+    SECTION("count")
+    {
+        vec.insert(vec.begin() + offset, count, TestType{ -1 });
+        expected.insert(expected.begin() + offset, count, TestType{ -1 });
+        REQUIRE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+    }
+    SECTION("range")
+    {
+        const std::vector<TestType> values(count, TestType{ -1 });
+        vec.insert(vec.begin() + offset, values.begin(), values.end());
+        expected.insert(expected.begin() + offset, count, TestType{ -1 });
+        REQUIRE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+    }
+    SECTION("aliased value")
+    {
+        vec.insert(vec.begin() + offset, count, vec.back());
+        expected.insert(expected.begin() + offset, count, TestType{ int(size - 1) });
+        REQUIRE(std::equal(vec.begin(), vec.end(), expected.begin(), expected.end()));
+    }
+}
+
 TEST_CASE("insert(pos, InputIter, InputIter)", "[modifiers]")
 {
     small_vector<char> dest(2, 'a');
@@ -894,7 +1670,89 @@ TEST_CASE("insert(pos, InputIter, InputIter)", "[modifiers]")
     }
 }
 
-TEMPLATE_TEST_CASE("emplace(pos, Args&&...)", "[modifiers]", TrivialType, NonTrivialType, MoveOnlyType)
+TEMPLATE_TEST_CASE("insert_range(pos, R&&)", "[modifiers]", TrivialType, NonTrivialType, RelocatableType)
+{
+    const size_t size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+
+    small_vector<TestType> dest(2, TestType{ 1 });
+    const std::vector<int> src(size, 2);
+
+    SECTION("contiguous")
+    {
+        auto it = dest.insert_range(dest.begin() + 1, src);
+
+        REQUIRE(dest.size() == size + 2);
+        REQUIRE(it == dest.begin() + 1);
+        REQUIRE(std::all_of(it, it + size, equal_to(TestType{ 2 })));
+        REQUIRE(dest.back() == TestType{ 1 });
+    }
+    SECTION("transform")
+    {
+        auto it = dest.insert_range(dest.begin(), src | std::views::transform([](int i) { return TestType{ 2 * i }; }));
+
+        REQUIRE(dest.size() == size + 2);
+        REQUIRE(it == dest.begin());
+        REQUIRE(std::all_of(it, it + size, equal_to(TestType{ 4 })));
+    }
+    SECTION("take")
+    {
+        auto it = dest.insert_range(dest.end(), std::views::iota(0) | std::views::take(size));
+
+        REQUIRE(dest.size() == size + 2);
+        REQUIRE(*it == TestType{ 0 });
+        REQUIRE(dest.back() == TestType{ int(size) - 1 });
+    }
+    SECTION("input")
+    {
+        std::istringstream input("3 3 3");
+        auto it = dest.insert_range(dest.begin() + 1, std::views::istream<int>(input));
+
+        REQUIRE(dest == small_vector<TestType>{ 1, 3, 3, 3, 1 });
+        REQUIRE(it == dest.begin() + 1);
+    }
+}
+
+TEMPLATE_TEST_CASE("append_range(R&&)", "[modifiers]", TrivialType, NonTrivialType)
+{
+    const size_t size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
+
+    small_vector<TestType> dest(SMALL_SIZE, TestType{ 1 });
+    dest.append_range(std::views::iota(0, int(size)));
+
+    REQUIRE(dest.size() == SMALL_SIZE + size);
+    REQUIRE(std::equal(dest.begin() + SMALL_SIZE, dest.end(), std::views::iota(0, int(size)).begin()));
+}
+
+TEMPLATE_TEST_CASE("assign_range(R&&)", "[assignment]", TrivialType, NonTrivialType)
+{
+    const size_t src_size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
+    const size_t dest_size = GENERATE(EMPTY, SMALL_SIZE, LARGE_SIZE);
+
+    small_vector<TestType> dest(dest_size, TestType{ 1 });
+    dest.assign_range(std::views::iota(0, int(src_size)) | std::views::transform([](int i) { return TestType{ i }; }));
+
+    REQUIRE(dest.size() == src_size);
+    REQUIRE(std::equal(dest.begin(), dest.end(), std::views::iota(0, int(src_size)).begin()));
+
+    std::istringstream input("5 5");
+    dest.assign_range(std::views::istream<int>(input));
+    REQUIRE(dest == small_vector<TestType>{ 5, 5 });
+}
+
+#if __cpp_lib_ranges_to_container
+TEST_CASE("ranges::to", "[constructor]")
+{
+    auto vec = std::views::iota(0, int(LARGE_SIZE)) | std::ranges::to<small_vector<int>>();
+
+    REQUIRE(vec.size() == LARGE_SIZE);
+    REQUIRE(vec.back() == int(LARGE_SIZE) - 1);
+
+    small_vector vec2(std::from_range, std::vector<int>(SMALL_SIZE, 3));
+    REQUIRE(vec2 == small_vector<int>(SMALL_SIZE, 3));
+}
+#endif
+
+TEMPLATE_TEST_CASE("emplace(pos, Args&&...)", "[modifiers]", TrivialType, NonTrivialType, MoveOnlyType, RelocatableType)
 {
     small_vector<TestType> vec(2);
 
@@ -921,6 +1779,367 @@ TEMPLATE_TEST_CASE("emplace(pos, Args&&...)", "[modifiers]", TrivialType, NonTri
     REQUIRE(vec.back() == TestType{ 2 });
 }
 
+TEST_CASE("trivial_relocation", "[modifiers]")
+{
+    STATIC_REQUIRE(is_trivially_relocatable_v<int>);
+    STATIC_REQUIRE(is_trivially_relocatable_v<RelocatableType>);
+    STATIC_REQUIRE(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    STATIC_REQUIRE(is_trivially_relocatable_v<std::pair<std::unique_ptr<int>, int>>);
+    STATIC_REQUIRE(!is_trivially_relocatable_v<NonTrivialType>);
+
+    small_vector<std::unique_ptr<int>, 4> vec;
+    for (int i = 0; i < 6; i++) vec.push_back(std::make_unique<int>(i));
+
+    vec.erase(vec.begin() + 1, vec.begin() + 3);
+    REQUIRE(vec.size() == 4);
+    REQUIRE(*vec[1] == 3);
+
+    vec.insert(vec.begin() + 1, std::make_unique<int>(10));
+    vec.emplace(vec.begin(), new int(11));
+    REQUIRE(*vec[0] == 11);
+    REQUIRE(*vec[2] == 10);
+    REQUIRE(*vec.back() == 5);
+
+    small_vector<std::unique_ptr<int>, 4> other;
+    other.push_back(std::make_unique<int>(20));
+
+    vec.swap(other);
+    REQUIRE(vec.size() == 1);
+    REQUIRE(other.size() == 6);
+
+    vec.swap(other);
+    vec.erase(vec.begin() + 4, vec.end());
+    REQUIRE(*vec[0] == 11);
+    REQUIRE(*vec[3] == 3);
+    REQUIRE(*other[0] == 20);
+
+    small_vector<std::unique_ptr<int>, 4> left, right;
+    for (int i = 0; i < 3; i++) left.push_back(std::make_unique<int>(i));
+    right.push_back(std::make_unique<int>(30));
+
+    left.swap(right);
+    REQUIRE(left.size() == 1);
+    REQUIRE(*left[0] == 30);
+    REQUIRE(right.size() == 3);
+    REQUIRE(*right[2] == 2);
+
+    small_vector<std::unique_ptr<int>, 4> moved(std::move(right));
+    REQUIRE(moved.size() == 3);
+    REQUIRE(*moved[0] == 0);
+}
+
+    //-----------------------------------//
+    //          SMALL VECTOR REF         //
+    //-----------------------------------//
+
+// Takes a size-erased reference, so it is only instantiated once for every element type
+template<typename T>
+static void append_through_ref(small_vector_ref<T> ref, int first, int last)
+{
+    for (int i = first; i < last; i++) ref.emplace_back(i);
+}
+
+TEMPLATE_TEST_CASE("small_vector_ref", "[small_vector_ref]", TrivialType, NonTrivialType, MoveOnlyType, RelocatableType)
+{
+    small_vector<TestType, 2> small;
+    small_vector<TestType, 16> large;
+
+    append_through_ref<TestType>(small, 0, 10);
+    append_through_ref<TestType>(large, 0, 10);
+
+    REQUIRE(small.size() == 10);
+    REQUIRE(!small.is_small());
+    REQUIRE(large.size() == 10);
+    REQUIRE(large.is_small());
+
+    for (int i = 0; i < 10; i++)
+    {
+        REQUIRE(small[i] == TestType(i));
+        REQUIRE(large[i] == TestType(i));
+    }
+
+    small_vector_ref ref = small;
+    STATIC_REQUIRE(std::is_same_v<decltype(ref), small_vector_ref<TestType>>);
+
+    REQUIRE(ref.size() == small.size());
+    REQUIRE(ref.data() == small.data());
+    REQUIRE(ref.inline_capacity() == small.inline_capacity());
+
+    SECTION("insert/emplace")
+    {
+        ref.insert(ref.begin(), TestType(-1));
+        ref.emplace(ref.begin() + 5, -2);
+        ref.insert(ref.end(), TestType(-3));
+
+        REQUIRE(small.size() == 13);
+        REQUIRE(small.front() == TestType(-1));
+        REQUIRE(small[5] == TestType(-2));
+        REQUIRE(small.back() == TestType(-3));
+
+        for (size_t i = 0; i < 100; i++) ref.emplace(ref.begin() + 1, int(i));
+        REQUIRE(small.size() == 113);
+        REQUIRE(small[1] == TestType(99));
+        REQUIRE(small.back() == TestType(-3));
+    }
+    SECTION("erase")
+    {
+        REQUIRE(*ref.erase(ref.begin() + 2) == TestType(3));
+        REQUIRE(*ref.erase(ref.begin(), ref.begin() + 2) == TestType(3));
+        REQUIRE(small.size() == 7);
+        REQUIRE(small.front() == TestType(3));
+        REQUIRE(small.back() == TestType(9));
+    }
+    SECTION("reserve/resize")
+    {
+        ref.reserve(LARGE_SIZE);
+        REQUIRE(small.capacity() >= LARGE_SIZE);
+        REQUIRE(small.size() == 10);
+
+        ref.resize(LARGE_SIZE);
+        REQUIRE(small.size() == LARGE_SIZE);
+        REQUIRE(small[9] == TestType(9));
+        REQUIRE(small.back() == TestType{});
+
+        ref.resize(1);
+        REQUIRE(small.size() == 1);
+        REQUIRE(small.front() == TestType(0));
+
+        ref.clear();
+        REQUIRE(small.empty());
+    }
+}
+
+TEST_CASE("small_vector_ref_insert", "[small_vector_ref]")
+{
+    small_vector<std::string, 4> vec = { "a", "b" };
+    small_vector_ref ref = vec;
+
+    const std::string strings[] = { "c", "d", "e" };
+    ref.insert(ref.begin() + 1, std::begin(strings), std::end(strings));
+    ref.insert(ref.begin(), { "f", "g" });
+
+    std::istringstream stream("h i");
+    ref.insert(ref.end(), std::istream_iterator<std::string>(stream), std::istream_iterator<std::string>());
+
+    REQUIRE(vec == small_vector<std::string, 4>{ "f", "g", "a", "c", "d", "e", "b", "h", "i" });
+
+    // The argument refers to an element of the vector that is invalidated by the reallocation
+    vec.shrink_to_fit();
+    ref.push_back(vec.front());
+    ref.insert(ref.begin(), vec.back());
+
+    REQUIRE(vec.size() == 11);
+    REQUIRE(vec.front() == "f");
+    REQUIRE(vec.back() == "f");
+
+    REQUIRE_THROWS(ref.at(11));
+    REQUIRE(ref.at(10) == "f");
+
+    ref.insert(ref.begin() + 1, 2, vec.back());
+    REQUIRE(vec.size() == 13);
+    REQUIRE(vec[2] == "f");
+    REQUIRE(vec[3] == "f");
+    REQUIRE(vec[4] == "g");
+}
+
+TEST_CASE("small_vector_ref_policies", "[small_vector_ref]")
+{
+    small_vector<int, 4, std::allocator<int>, ShrinkOptions> shrinking(LARGE_SIZE, 3);
+    small_vector_ref shrinking_ref = shrinking;
+
+    shrinking_ref.erase(shrinking_ref.begin() + 2, shrinking_ref.end());
+    REQUIRE(shrinking.is_small());
+    REQUIRE(shrinking == small_vector<int, 4, std::allocator<int>, ShrinkOptions>{ 3, 3 });
+
+    stats_registry::instance().reset();
+    {
+        small_vector<int, 4, std::allocator<int>, StatsOptions> vec;
+        small_vector_ref ref = vec;
+
+        for (int i = 0; i < 5; i++) ref.push_back(i);
+    }
+    // The events are attributed to the referenced vector
+    const stats_counters counters = stats_registry::instance().get("stats_test");
+    REQUIRE(counters.spills == 1);
+    REQUIRE(counters.deallocate == 1);
+}
+
+TEST_CASE("small_vector_ref_stats_events", "[small_vector_ref]")
+{
+    const auto modify = [](auto&& vec)
+    {
+        const int values[] = { 1, 2, 3 };
+
+        for (int i = 0; i < 100; i++) vec.push_back(i);
+        for (int i = 0; i < 100; i++) vec.emplace(vec.begin(), i);
+        for (int i = 0; i < 100; i++) vec.insert(vec.begin(), std::begin(values), std::end(values));
+    };
+
+    stats_registry::instance().reset();
+    {
+        small_vector<int, 4, std::allocator<int>, StatsOptions> vec;
+        modify(vec);
+    }
+    const stats_counters direct = stats_registry::instance().get("stats_test");
+
+    stats_registry::instance().reset();
+    {
+        small_vector<int, 4, std::allocator<int>, StatsOptions> vec;
+        modify(small_vector_ref(vec));
+    }
+    const stats_counters through_ref = stats_registry::instance().get("stats_test");
+
+    // The reference reports the same events as the vector for the same operations
+    REQUIRE(direct.reallocate_append > 0);
+    REQUIRE(direct.reallocate_emplace > 0);
+    REQUIRE(direct.reallocate_insert > 0);
+
+    REQUIRE(through_ref.reallocate == direct.reallocate);
+    REQUIRE(through_ref.reallocate_append == direct.reallocate_append);
+    REQUIRE(through_ref.reallocate_emplace == direct.reallocate_emplace);
+    REQUIRE(through_ref.reallocate_insert == direct.reallocate_insert);
+    REQUIRE(through_ref.relocated_bytes == direct.relocated_bytes);
+}
+
+    //-----------------------------------//
+    //             COMPARISON            //
+    //-----------------------------------//
+
+
+TEMPLATE_TEST_CASE("operator==/operator<=>", "[comparison]", std::uint8_t, std::byte, std::int8_t, std::uint16_t, std::int32_t, std::uint64_t, double, NonTrivialType)
+{
+    const size_t size = GENERATE(EMPTY, 1, SMALL_SIZE, 17, LARGE_SIZE);
+
+    auto make_value = [](size_t i)
+    {
+        if constexpr (std::is_same_v<TestType, std::byte>) return std::byte(i % 120);
+        else return TestType(int(i % 120));
+    };
+
+    auto compare = [](const auto& lhs, const auto& rhs)
+    {
+        if constexpr (std::is_same_v<TestType, NonTrivialType>) return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const auto& l, const auto& r) { return l.i_ <=> r.i_; });
+        else return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    };
+
+    small_vector<TestType, 8> lhs;
+    for (size_t i = 0; i < size; i++) lhs.push_back(make_value(i));
+
+    SECTION("equal")
+    {
+        small_vector<TestType, 8> rhs = lhs;
+
+        REQUIRE(lhs == rhs);
+        if constexpr (std::three_way_comparable<TestType>) REQUIRE(std::is_eq(lhs <=> rhs));
+    }
+    SECTION("prefix")
+    {
+        small_vector<TestType, 8> rhs = lhs;
+        rhs.push_back(make_value(0));
+
+        REQUIRE(lhs != rhs);
+        if constexpr (std::three_way_comparable<TestType>)
+        {
+            REQUIRE(std::is_lt(lhs <=> rhs));
+            REQUIRE(std::is_gt(rhs <=> lhs));
+        }
+    }
+    SECTION("mismatch")
+    {
+        // Test every position of the mismatch, with the differing elements in both orders
+        for (size_t pos = 0; pos < size; pos++)
+        {
+            small_vector<TestType, 8> rhs = lhs;
+            rhs[pos] = make_value(pos + 121);
+
+            REQUIRE(lhs != rhs);
+            if constexpr (std::three_way_comparable<TestType>)
+            {
+                REQUIRE((lhs <=> rhs) == compare(lhs, rhs));
+                REQUIRE((rhs <=> lhs) == compare(rhs, lhs));
+            }
+        }
+    }
+}
+
+TEST_CASE("operator<=>_signed", "[comparison]")
+{
+    small_vector<int> lhs{ 1, 2, -3, 4 };
+    small_vector<int> rhs{ 1, 2, 3, 4 };
+    REQUIRE(std::is_lt(lhs <=> rhs));
+
+    small_vector<char> lhs_chars{ 'a', char(-1) };
+    small_vector<char> rhs_chars{ 'a', char(1) };
+    REQUIRE((lhs_chars <=> rhs_chars) == (char(-1) <=> char(1)));
+
+    small_vector<std::uint32_t> lhs_unsigned{ 0x0100 };
+    small_vector<std::uint32_t> rhs_unsigned{ 0x0001 };
+    REQUIRE(std::is_gt(lhs_unsigned <=> rhs_unsigned));
+}
+
+#if SV_X86_SIMD
+TEST_CASE("mismatch_kernels", "[comparison]")
+{
+    for (size_t size = 0; size < 100; size++)
+    {
+        std::vector<unsigned char> lhs(size, 7);
+
+        for (size_t pos = 0; pos <= size; pos++)
+        {
+            std::vector<unsigned char> rhs = lhs;
+            if (pos != size) rhs[pos] = 8;
+
+            REQUIRE(detail::mismatch_sse2(lhs.data(), rhs.data(), size) == pos);
+            if (detail::cpu_has_avx2()) REQUIRE(detail::mismatch_avx2(lhs.data(), rhs.data(), size) == pos);
+        }
+    }
+}
+#endif
+
+TEMPLATE_TEST_CASE("std::hash", "[comparison]", std::uint8_t, std::int32_t, std::uint64_t, double, std::string)
+{
+    const size_t size = GENERATE(EMPTY, 1, SMALL_SIZE, 17, LARGE_SIZE);
+
+    auto make_value = [](size_t i)
+    {
+        if constexpr (std::is_same_v<TestType, std::string>) return std::string(i % 30, 'a');
+        else return TestType(i % 120);
+    };
+
+    small_vector<TestType, 1> small;
+    for (size_t i = 0; i < size; i++) small.push_back(make_value(i));
+
+    const small_vector<TestType, 64> large(small.begin(), small.end());
+    const compact_small_vector<TestType, 2> compact(small.begin(), small.end());
+
+    REQUIRE(std::hash<small_vector<TestType, 1>>{}(small) == std::hash<small_vector<TestType, 64>>{}(large));
+    REQUIRE(std::hash<small_vector<TestType, 1>>{}(small) == std::hash<compact_small_vector<TestType, 2>>{}(compact));
+
+    small.push_back(make_value(0));
+    REQUIRE(std::hash<small_vector<TestType, 1>>{}(small) != std::hash<small_vector<TestType, 64>>{}(large));
+}
+
+TEST_CASE("std::hash_distinct", "[comparison]")
+{
+    std::unordered_set<small_vector<std::uint32_t>> vectors;
+    std::unordered_set<size_t> hashes;
+
+    for (size_t size = 0; size < 64; size++)
+    {
+        for (std::uint32_t value = 0; value < 64; value++)
+        {
+            small_vector<std::uint32_t> vec(size, 0);
+            if (size) vec[value % size] = value + 1;
+
+            hashes.insert(std::hash<small_vector<std::uint32_t>>{}(vec));
+            vectors.insert(std::move(vec));
+        }
+    }
+    REQUIRE(hashes.size() == vectors.size());
+
+    STATIC_REQUIRE(!std::is_default_constructible_v<std::hash<small_vector<NonTrivialType>>>);
+}
+
     //-----------------------------------//
     //       ALLOCATOR PROPAGATION       //
     //-----------------------------------//
@@ -1013,3 +2232,354 @@ TEMPLATE_TEST_CASE("propagate_on_swap", "[allocators]", TrivialType, NonTrivialT
     REQUIRE(left == old_left);
     REQUIRE(right == old_right);
 }
+
+TEMPLATE_TEST_CASE("malloc_allocator", "[allocators]", TrivialType, NonTrivialType)
+{
+    STATIC_REQUIRE(detail::can_reallocate_v<malloc_allocator<TrivialType>, TrivialType>);
+    STATIC_REQUIRE(!detail::can_reallocate_v<malloc_allocator<NonTrivialType>, NonTrivialType>);
+
+    small_vector<TestType, 4, malloc_allocator<TestType>> vec;
+
+    for (int i = 0; i < int(LARGE_SIZE); i++) vec.push_back(TestType{ i });
+
+    REQUIRE(vec.size() == LARGE_SIZE);
+    REQUIRE(vec.front() == TestType{ 0 });
+    REQUIRE(vec.back() == TestType{ int(LARGE_SIZE) - 1 });
+
+    vec.shrink_to_fit();
+    REQUIRE(vec.capacity() == vec.size());
+
+    vec.push_back(vec.front());
+    REQUIRE(vec.back() == TestType{ 0 });
+
+    vec.reserve(4 * LARGE_SIZE);
+    REQUIRE(vec.capacity() >= 4 * LARGE_SIZE);
+    REQUIRE(vec[LARGE_SIZE - 1] == TestType{ int(LARGE_SIZE) - 1 });
+
+    small_vector<TestType, 4, malloc_allocator<TestType>> other(std::move(vec));
+    REQUIRE(other.size() == LARGE_SIZE + 1);
+
+    vec = std::move(other);
+    REQUIRE(vec.size() == LARGE_SIZE + 1);
+}
+
+TEMPLATE_TEST_CASE("arena_allocator", "[allocators]", TrivialType, NonTrivialType)
+{
+    STATIC_REQUIRE(detail::has_trivial_deallocate<arena_allocator<TestType>>);
+    STATIC_REQUIRE(detail::has_allocate_at_least_method<arena_allocator<TestType>>);
+
+    bump_arena arena;
+
+    small_vector<TestType, 4, arena_allocator<TestType>> vec(arena_allocator<TestType>{ arena });
+
+    for (int i = 0; i < int(LARGE_SIZE); i++) vec.push_back(TestType{ i });
+
+    REQUIRE(vec.size() == LARGE_SIZE);
+    REQUIRE(vec.front() == TestType{ 0 });
+    REQUIRE(vec.back() == TestType{ int(LARGE_SIZE) - 1 });
+    REQUIRE(vec.get_allocator().arena() == &arena);
+
+    SECTION("allocate_at_least")
+    {
+        small_vector<char, 1, arena_allocator<char>> chars(arena_allocator<char>{ arena });
+        chars.reserve(2);
+
+        REQUIRE(chars.capacity() == bump_arena::granularity);
+    }
+
+    SECTION("no shrinking on the heap")
+    {
+        const size_t old_capacity = vec.capacity();
+
+        vec.resize(SMALL_SIZE + 1);
+        vec.shrink_to_fit();
+        REQUIRE(vec.capacity() == old_capacity);
+
+        vec.resize(SMALL_SIZE);
+        vec.shrink_to_fit();
+        REQUIRE(vec.is_small());
+        REQUIRE(vec.back() == TestType{ int(SMALL_SIZE) - 1 });
+    }
+
+    SECTION("move and swap")
+    {
+        small_vector<TestType, 4, arena_allocator<TestType>> other(std::move(vec));
+        REQUIRE(other.size() == LARGE_SIZE);
+
+        vec = { TestType{ 1 } };
+        swap(vec, other);
+
+        REQUIRE(vec.size() == LARGE_SIZE);
+        REQUIRE(other.size() == 1);
+    }
+}
+
+TEST_CASE("bump_arena", "[allocators]")
+{
+    bump_arena arena(1024);
+
+    SECTION("reallocate in place")
+    {
+        small_vector<int, 4, arena_allocator<int>> vec(arena_allocator<int>{ arena });
+        vec.resize(SMALL_SIZE + 1);
+
+        const int* old_data = vec.data();
+        vec.reserve(2 * vec.capacity());
+
+        REQUIRE(vec.data() == old_data);
+    }
+
+    SECTION("rewind")
+    {
+        const bump_arena::checkpoint start = arena.mark();
+
+        small_vector<int, 4, arena_allocator<int>> vec(LARGE_SIZE, 3, arena_allocator<int>{ arena });
+        const int* old_data = vec.data();
+        const size_t reserved = arena.reserved();
+
+        arena.rewind(start);
+
+        small_vector<int, 4, arena_allocator<int>> other(LARGE_SIZE, 3, arena_allocator<int>{ arena });
+        REQUIRE(other.data() == old_data);
+        REQUIRE(arena.reserved() == reserved);
+    }
+
+    SECTION("large allocations")
+    {
+        small_vector<int, 4, arena_allocator<int>> vec(arena_allocator<int>{ arena });
+
+        for (int i = 0; i < int(LARGE_SIZE * LARGE_SIZE); i++) vec.push_back(i);
+
+        REQUIRE(vec.size() == LARGE_SIZE * LARGE_SIZE);
+        REQUIRE(vec.back() == int(LARGE_SIZE * LARGE_SIZE) - 1);
+        REQUIRE(arena.reserved() >= LARGE_SIZE * LARGE_SIZE * sizeof(int));
+    }
+
+    SECTION("over-aligned types")
+    {
+        struct alignas(64) OverAligned { int i; };
+
+        small_vector<OverAligned, 1, arena_allocator<OverAligned>> vec(arena_allocator<OverAligned>{ arena });
+        vec.resize(LARGE_SIZE);
+
+        REQUIRE(reinterpret_cast<std::uintptr_t>(vec.data()) % 64 == 0);
+    }
+}
+
+TEST_CASE("arena_scope", "[allocators]")
+{
+    bump_arena& arena = bump_arena::thread_local_arena();
+    const bump_arena::checkpoint start = arena.mark();
+
+    {
+        arena_scope scope;
+
+        small_vector<int, 4, arena_allocator<int>> vec(LARGE_SIZE);
+        REQUIRE(vec.get_allocator().arena() == &arena);
+        REQUIRE(arena.mark().top != start.top);
+    }
+
+    REQUIRE(arena.mark().top == start.top);
+    REQUIRE(arena.mark().block == start.block);
+}
+
+TEMPLATE_TEST_CASE("small_vector_pmr", "[allocators]", std::pmr::monotonic_buffer_resource, std::pmr::unsynchronized_pool_resource, std::pmr::synchronized_pool_resource)
+{
+    using Vector = small_vector_pmr::small_vector<int, 4>;
+
+    STATIC_REQUIRE(detail::memcpy_relocatable_v<std::pmr::polymorphic_allocator<int>, int>);
+    STATIC_REQUIRE(!detail::has_trivial_construct_v<std::pmr::polymorphic_allocator<std::pmr::string>, std::pmr::string, std::pmr::string&&>);
+    STATIC_REQUIRE(!detail::has_trivial_construct_v<std::pmr::polymorphic_allocator<std::pair<int, int>>, std::pair<int, int>, int, int>);
+
+    TestType resource;
+    TestType other_resource;
+
+    const size_t src_size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+    const size_t dest_size = GENERATE(SMALL_SIZE, LARGE_SIZE);
+
+    Vector source(src_size, 4, &resource);
+    const Vector src_copy(source);
+
+    SECTION("move assignment with equal resources")
+    {
+        Vector dest(dest_size, 3, &resource);
+        const int* src_data = source.data();
+
+        dest = std::move(source);
+
+        REQUIRE(dest == src_copy);
+        REQUIRE(dest.get_allocator().resource() == &resource);
+        if (src_size > SMALL_SIZE) REQUIRE(dest.data() == src_data);
+    }
+
+    SECTION("move assignment with different resources")
+    {
+        Vector dest(dest_size, 3, &other_resource);
+        const int* src_data = source.data();
+
+        dest = std::move(source);
+
+        REQUIRE(dest == src_copy);
+        REQUIRE(dest.get_allocator().resource() == &other_resource);
+        REQUIRE(dest.data() != src_data);
+    }
+
+    SECTION("move construction with an allocator")
+    {
+        const int* src_data = source.data();
+
+        Vector same(std::move(source), &resource);
+        REQUIRE(same == src_copy);
+        if (src_size > SMALL_SIZE) REQUIRE(same.data() == src_data);
+
+        Vector different(std::move(same), &other_resource);
+        REQUIRE(different == src_copy);
+        REQUIRE(different.get_allocator().resource() == &other_resource);
+        REQUIRE(same.empty());
+    }
+
+    SECTION("swap")
+    {
+        Vector other(dest_size, 3, &resource);
+        const Vector other_copy(other);
+
+        swap(source, other);
+
+        REQUIRE(source == other_copy);
+        REQUIRE(other == src_copy);
+    }
+
+    SECTION("uses-allocator construction")
+    {
+        std::pmr::vector<small_vector_pmr::small_vector<std::pmr::string, 2>> outer(&resource);
+
+        for (size_t i = 0; i < src_size; i++)
+        {
+            outer.emplace_back().emplace_back(LARGE_SIZE, 'a');
+        }
+
+        REQUIRE(outer.size() == src_size);
+        REQUIRE(outer.back().get_allocator().resource() == &resource);
+        REQUIRE(outer.back().front().get_allocator().resource() == &resource);
+        REQUIRE(outer.back().front() == std::pmr::string(LARGE_SIZE, 'a'));
+    }
+}
+
+    //-----------------------------------//
+    //           SERIALIZATION           //
+    //-----------------------------------//
+
+struct SerializedPoint
+{
+    std::int32_t x;
+    std::int32_t y;
+    friend bool operator==(const SerializedPoint&, const SerializedPoint&) = default;
+};
+
+TEMPLATE_TEST_CASE("serialization", "[serialization]", std::uint8_t, std::int16_t, std::uint64_t, double, SerializedPoint)
+{
+    const size_t size = GENERATE(EMPTY, 1, 3, SMALL_SIZE, LARGE_SIZE);
+
+    small_vector<TestType, 4> vec;
+    for (size_t i = 0; i < size; i++)
+    {
+        if constexpr (std::is_same_v<TestType, SerializedPoint>) vec.push_back(SerializedPoint{ int(i), -int(i) });
+        else vec.push_back(TestType(i % 120));
+    }
+
+    SECTION("span")
+    {
+        std::vector<std::byte> buffer(serialized_size(vec) + 5, std::byte(0xff));
+
+        REQUIRE(write_to(vec, std::span(buffer)) == serialized_size(vec));
+        REQUIRE(serialized_size(vec) % serialization_alignment == 0);
+
+        small_vector<TestType, 64> result(10);
+        REQUIRE(read_from(result, std::span<const std::byte>(buffer)) == serialized_size(vec));
+        REQUIRE(std::ranges::equal(result, vec));
+
+        REQUIRE_THROWS(write_to(vec, std::span(buffer).first(serialized_size(vec) - 1)));
+        REQUIRE_THROWS(read_from(result, std::span<const std::byte>(buffer).first(serialized_size(vec) - 1)));
+        REQUIRE(result.empty());
+    }
+    SECTION("stream")
+    {
+        std::stringstream stream;
+        write_to(vec, stream);
+        write_to(vec, stream);
+        REQUIRE(stream.str().size() == 2 * serialized_size(vec));
+
+        small_vector<TestType, 2> first, second;
+        REQUIRE(read_from(first, stream));
+        REQUIRE(read_from(second, stream));
+        REQUIRE(std::ranges::equal(first, vec));
+        REQUIRE(std::ranges::equal(second, vec));
+
+        REQUIRE(!read_from(first, stream));
+        REQUIRE(first.empty());
+    }
+    SECTION("view")
+    {
+        alignas(std::max_align_t) std::byte buffer[2 * serialization_header_size + 2 * LARGE_SIZE * sizeof(TestType) + 2 * serialization_alignment];
+
+        const size_t first_size = write_to(vec, std::span(buffer));
+        write_to(vec, std::span(buffer).subspan(first_size));
+
+        const std::span<const TestType> first = serialized_view<TestType>(buffer);
+        const std::span<const TestType> second = serialized_view<TestType>(std::span(buffer).subspan(first_size));
+
+        REQUIRE(std::ranges::equal(first, vec));
+        REQUIRE(std::ranges::equal(second, vec));
+        REQUIRE(static_cast<const void*>(first.data()) == buffer + serialization_header_size);
+    }
+}
+
+TEST_CASE("serialization_format", "[serialization]")
+{
+    const small_vector<std::uint16_t> vec = { 0x0102, 0x0304, 0x0506 };
+
+    std::byte buffer[serialized_size<std::uint16_t>(3)];
+    write_to(vec, std::span(buffer));
+
+    const std::uint8_t expected[] = { 3, 0, 0, 0, 0, 0, 0, 0,  2, 0, 0, 0, 0, 0, 0, 0,  0x02, 0x01, 0x04, 0x03, 0x06, 0x05, 0, 0 };
+    REQUIRE(sizeof(buffer) == sizeof(expected));
+    REQUIRE(std::memcmp(buffer, expected, sizeof(buffer)) == 0);
+
+    small_vector<std::uint32_t> wrong_type;
+    REQUIRE_THROWS_AS(read_from(wrong_type, std::span<const std::byte>(buffer)), std::runtime_error);
+    REQUIRE_THROWS_AS(serialized_view<std::uint32_t>(buffer), std::runtime_error);
+    REQUIRE_THROWS_AS(serialized_view<std::uint16_t>(std::span(buffer).first(8)), std::runtime_error);
+
+    std::stringstream stream(std::string(reinterpret_cast<const char*>(buffer), sizeof(buffer)));
+    REQUIRE(!read_from(wrong_type, stream));
+}
+
+TEST_CASE("serialization_invalid_stream", "[serialization]")
+{
+    small_vector<std::uint32_t> vec = { 1, 2, 3 };
+
+    SECTION("huge count")
+    {
+        std::byte header[serialization_header_size] = {};
+        header[7] = std::byte(0x08); // 2^59 elements
+        header[8] = std::byte(sizeof(std::uint32_t));
+
+        std::stringstream stream(std::string(reinterpret_cast<const char*>(header), sizeof(header)) + std::string(64, '\0'));
+        REQUIRE(!read_from(vec, stream));
+        REQUIRE(vec.empty());
+    }
+
+    SECTION("truncated")
+    {
+        const small_vector<std::uint32_t> source(50000, 7);
+
+        std::stringstream stream;
+        write_to(source, stream);
+        std::string data = stream.str();
+        data.resize(data.size() - 100);
+
+        std::stringstream truncated(data);
+        REQUIRE(!read_from(vec, truncated));
+        REQUIRE(vec.empty());
+    }
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2024 Krisztián Rugási. Subject to the MIT License. */
+
+// Generates a header of recommended small_vector inline capacities from a size profile
+// dumped by size_profile_registry::dump().
+//
+// Usage: size_profile_to_header <profile> [<output header>] [--namespace <name>] [--spill-cost <bytes>]
+
+#include <small_vector_stats.hpp>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <exception>
+#include <cstdlib>
+
+int main(int argc, char** argv)
+{
+    std::string input;
+    std::string output;
+    std::string ns = "small_vector_sizes";
+    double spill_cost = 64.0;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+
+            if (arg == "--namespace" && i + 1 < argc) ns = argv[++i];
+            else if (arg == "--spill-cost" && i + 1 < argc) spill_cost = std::stod(argv[++i]);
+            else if (input.empty()) input = arg;
+            else if (output.empty()) output = arg;
+            else throw std::invalid_argument("Unexpected argument: " + arg);
+        }
+
+        if (input.empty())
+        {
+            std::cerr << "Usage: size_profile_to_header <profile> [<output header>] [--namespace <name>] [--spill-cost <bytes>]\n";
+            return EXIT_FAILURE;
+        }
+
+        std::ifstream profile_file(input);
+        if (!profile_file) throw std::runtime_error("Couldn't open the profile: " + input);
+
+        const std::vector<size_profile> profiles = read_size_profiles(profile_file);
+
+        if (output.empty())
+        {
+            write_size_header(std::cout, profiles, ns, spill_cost);
+        }
+        else
+        {
+            std::ofstream header_file(output);
+            if (!header_file) throw std::runtime_error("Couldn't open the output file: " + output);
+            write_size_header(header_file, profiles, ns, spill_cost);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "size_profile_to_header: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}